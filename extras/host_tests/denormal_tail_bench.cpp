@@ -0,0 +1,123 @@
+/*
+ * host benchmark of the processing time during decaying tails
+ *
+ * the reverb and a resonant biquad get one second of noise followed by silence,
+ * the time per block is printed every ten seconds of audio
+ * without denormal protection the time rises many times once the tails become denormal
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src denormal_tail_bench.cpp ../../src/ml_reverb.cpp ../../src/ml_filter.cpp -o denormal_tail_bench
+ */
+
+
+#include <ml_reverb.h>
+#include <ml_filter.h>
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+
+
+Stream Serial;
+
+
+#define SAMPLE_RATE     44100
+#define BLOCK_LEN       64
+#define SECONDS         90
+#define FILTER_VOICES   64
+#define RISE_MAX        4.0 /* unprotected reverb tails reach 20 and more */
+
+
+static float reverbBuffer[REV_BUFF_SIZE];
+static struct filterCoeffT filterCoeff;
+static struct filterProcT filterProc[FILTER_VOICES];
+static float filterBuf[FILTER_VOICES][BLOCK_LEN];
+
+
+static uint32_t noiseState = 1;
+
+static float Noise(void)
+{
+    noiseState = noiseState * 1664525 + 1013904223;
+    return (noiseState >> 8) / 8388608.0f - 1.0f;
+}
+
+/*
+ * ratio between the slowest and the fastest second,
+ * the second slowest and second fastest are used so a single outlier on a busy host is tolerated
+ */
+static double Rise(const double *us, int cnt)
+{
+    double sorted[SECONDS];
+    for (int i = 0; i < cnt; i++)
+    {
+        sorted[i] = us[i];
+    }
+    std::sort(sorted, sorted + cnt);
+    return sorted[cnt - 2] / sorted[1];
+}
+
+int main()
+{
+    ML_Reverb reverb;
+    reverb.setup(reverbBuffer);
+    reverb.setLevel(0.5f);
+
+    Filter_Calculate(0.3f, 4.0f, &filterCoeff);
+    for (int v = 0; v < FILTER_VOICES; v++)
+    {
+        Filter_Init(&filterProc[v], &filterCoeff);
+    }
+
+    float reverbBuf[BLOCK_LEN];
+    double reverbUs[SECONDS];
+    double filterUs[SECONDS];
+
+    printf("  time  reverb us/block  %d biquads us/block\n", FILTER_VOICES);
+
+    for (int s = 0; s < SECONDS; s++)
+    {
+        const float level = (s == 0) ? 0.5f : 0.0f;
+        const int blocks = SAMPLE_RATE / BLOCK_LEN;
+
+        /* one second of each module is timed as a whole, single blocks are too short for the clock */
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int b = 0; b < blocks; b++)
+        {
+            for (int n = 0; n < BLOCK_LEN; n++)
+            {
+                reverbBuf[n] = Noise() * level;
+            }
+            reverb.process(reverbBuf, BLOCK_LEN);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        for (int b = 0; b < blocks; b++)
+        {
+            for (int v = 0; v < FILTER_VOICES; v++)
+            {
+                for (int n = 0; n < BLOCK_LEN; n++)
+                {
+                    filterBuf[v][n] = Noise() * level;
+                }
+                Filter_Process_Buffer(filterBuf[v], &filterProc[v], BLOCK_LEN);
+            }
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+
+        reverbUs[s] = std::chrono::duration<double, std::micro>(t1 - t0).count() / blocks;
+        filterUs[s] = std::chrono::duration<double, std::micro>(t2 - t1).count() / blocks;
+
+        if ((s % 10 == 0) || (s == SECONDS - 1))
+        {
+            printf("%4d s %12.3f %18.3f\n", s, reverbUs[s], filterUs[s]);
+        }
+    }
+
+    const double reverbRise = Rise(reverbUs, SECONDS);
+    const double filterRise = Rise(filterUs, SECONDS);
+    printf("slowest / fastest second: reverb %.2f, biquads %.2f\n", reverbRise, filterRise);
+
+    const bool ok = (reverbRise < RISE_MAX) && (filterRise < RISE_MAX);
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+ * host benchmark of the sample accurate event rendering
+ *
+ * - checks the split points of EventQueue_Render for events pushed out of order
+ *   and for an event behind the end of the block
+ * - renders an oscillator bank with 16 voices in blocks of 64 samples which are split
+ *   by 0 to 8 events and prints the time per block and the cost per split,
+ *   sample accurate and with a granularity of 8 samples
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src event_split_bench.cpp ../../src/ml_event.cpp ../../src/ml_osc.cpp ../../src/ml_lut.cpp -o event_split_bench
+ */
+
+
+#include <ml_event.h>
+#include <ml_osc.h>
+#include <ml_lut.h>
+
+#include <stdio.h>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define VOICES      16
+#define BLOCK_LEN   64
+#define BLOCKS      50000
+#define SPLITS_MAX  8
+
+
+static struct oscBankT bank;
+static struct synth_osc_cfg_s cfg;
+static float sineTable[WAVEFORM_CNT];
+static float left[BLOCK_LEN], right[BLOCK_LEN];
+
+static uint32_t partOffset[BLOCK_LEN];
+static uint32_t partLen[BLOCK_LEN];
+static uint32_t partCnt;
+
+
+static void RecordPart(uint32_t offset, uint32_t len, void *arg __attribute__((unused)))
+{
+    partOffset[partCnt] = offset;
+    partLen[partCnt] = len;
+    partCnt++;
+}
+
+static void IgnoreEvent(const struct timedEventT *ev __attribute__((unused)), void *arg __attribute__((unused)))
+{
+}
+
+static void RenderPart(uint32_t offset, uint32_t len, void *arg __attribute__((unused)))
+{
+    OscBank_Process(&bank, &left[offset], &right[offset], len);
+}
+
+static void HandleEvent(const struct timedEventT *ev, void *arg __attribute__((unused)))
+{
+    OscBank_SetPitch(&bank, ev->data1, 100000000u + ev->data2);
+}
+
+/*
+ * the parts of one block must match the expected offsets and cover the whole block
+ */
+static bool CheckParts(struct eventQueueT *queue, const uint32_t *expected, uint32_t cnt)
+{
+    partCnt = 0;
+    EventQueue_Render(queue, BLOCK_LEN, RecordPart, IgnoreEvent, NULL);
+
+    bool ok = (partCnt == cnt);
+    uint32_t sum = 0;
+    for (uint32_t i = 0; ok && (i < cnt); i++)
+    {
+        ok = (partOffset[i] == expected[i]) && (partOffset[i] == sum);
+        sum += partLen[i];
+    }
+    ok = ok && (sum == BLOCK_LEN);
+
+    printf("parts:");
+    for (uint32_t i = 0; i < partCnt; i++)
+    {
+        printf(" %u+%u", partOffset[i], partLen[i]);
+    }
+    printf("%s\n", ok ? "" : "  (wrong)");
+
+    return ok;
+}
+
+static double BlockTime(struct eventQueueT *queue, int splits)
+{
+    double s = 0;
+    for (int b = 0; b < BLOCKS; b++)
+    {
+        for (int i = 0; i < splits; i++)
+        {
+            EventQueue_Push(queue, queue->now + (i + 1) * BLOCK_LEN / (splits + 1) + 1, 0x90, i, b & 1);
+        }
+
+        const auto t0 = std::chrono::steady_clock::now();
+        EventQueue_Render(queue, BLOCK_LEN, RenderPart, HandleEvent, NULL);
+        s += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    return s / BLOCKS;
+}
+
+int main()
+{
+    bool ok = true;
+
+    struct eventQueueT queue;
+    EventQueue_Init(&queue, 44100);
+
+    /* pushed out of order, the event at 70 belongs to the next block */
+    EventQueue_Push(&queue, 70, 0x90, 1, 2);
+    EventQueue_Push(&queue, 10, 0x90, 1, 2);
+    EventQueue_Push(&queue, 33, 0x90, 1, 2);
+    const uint32_t first[] = {0, 10, 33};
+    const uint32_t second[] = {0, 6};
+    ok = CheckParts(&queue, first, 3) && ok;
+    ok = CheckParts(&queue, second, 2) && ok;
+
+    for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+    {
+        sineTable[n] = mlLutSine.v[n];
+    }
+    static float multiplier = 1.0f;
+    static float morph = 0.0f;
+    cfg.selectedWaveForm = sineTable;
+    cfg.morphWaveForm = sineTable;
+    cfg.pitchMultiplier = &multiplier;
+    cfg.morph = &morph;
+    cfg.pitchOctave = 1.0f;
+    cfg.pitch = 1.0f;
+    cfg.volume = 0.1f;
+
+    OscBank_Init(&bank);
+    for (int v = 0; v < VOICES; v++)
+    {
+        OscBank_SetVoice(&bank, v, &cfg, 50000000 + v * 1000000, NULL);
+    }
+
+    const uint32_t granularity[] = {1, 8};
+    for (int g = 0; g < 2; g++)
+    {
+        EventQueue_SetGranularity(&queue, granularity[g]);
+        printf("granularity %u, %d voices, %d samples per block\n", granularity[g], VOICES, BLOCK_LEN);
+
+        const double t0 = BlockTime(&queue, 0);
+        printf("  splits 0: %6.0f ns per block\n", t0 * 1e9);
+        for (int splits = 2; splits <= SPLITS_MAX; splits += 2)
+        {
+            const double t = BlockTime(&queue, splits);
+            printf("  splits %d: %6.0f ns per block, %4.0f ns per split\n", splits, t * 1e9, (t - t0) / splits * 1e9);
+        }
+    }
+
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
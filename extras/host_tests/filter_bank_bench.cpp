@@ -0,0 +1,121 @@
+/*
+ * host benchmark of the biquad filter bank
+ *
+ * filters 64 voices with 64 samples each with
+ * - one Filter_Process_Buffer call per voice
+ * - FilterBank_Process (voice buffers, transposed inside)
+ * - FilterBank_ProcessGroup (already interleaved buffers)
+ * and checks that the bank gives the same result as Filter_Process_Buffer
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src filter_bank_bench.cpp ../../src/ml_filter.cpp -o filter_bank_bench
+ * add -mavx2 -mfma for 8 lanes or -U__SSE2__ for the scalar version
+ */
+
+
+#include <ml_filter.h>
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define VOICES      64
+#define BLOCK_LEN   64
+#define BLOCKS      50000
+#define DIFF_MAX    1e-4
+
+
+static struct filterBankT bank;
+static struct filterCoeffT coeff[VOICES];
+static struct filterProcT proc[VOICES];
+static float bankBuf[VOICES][BLOCK_LEN];
+static float refBuf[VOICES][BLOCK_LEN];
+static float interleaved[FILTER_BANK_LANES * BLOCK_LEN];
+
+
+static uint32_t noiseState = 1;
+
+static float Noise(void)
+{
+    noiseState = noiseState * 1664525 + 1013904223;
+    return (noiseState >> 8) / 8388608.0f - 1.0f;
+}
+
+template<typename F>
+static double Measure(F process)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        process();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / BLOCKS;
+}
+
+int main()
+{
+    float *signal[VOICES];
+
+    FilterBank_Init(&bank);
+    for (int v = 0; v < VOICES; v++)
+    {
+        Filter_Calculate(0.2f + v * 0.01f, 1.0f + v * 0.05f, &coeff[v]);
+        Filter_Init(&proc[v], &coeff[v]);
+        FilterBank_SetCoeff(&bank, v, &coeff[v]);
+        signal[v] = bankBuf[v];
+    }
+
+    double diff = 0;
+    for (int b = 0; b < 100; b++)
+    {
+        for (int v = 0; v < VOICES; v++)
+        {
+            for (int n = 0; n < BLOCK_LEN; n++)
+            {
+                bankBuf[v][n] = refBuf[v][n] = Noise();
+            }
+        }
+
+        /* odd block lengths check the remainder of the vector loop */
+        const int len = (b & 1) ? BLOCK_LEN : (BLOCK_LEN - 3);
+        FilterBank_Process(&bank, signal, len);
+        for (int v = 0; v < VOICES; v++)
+        {
+            Filter_Process_Buffer(refBuf[v], &proc[v], len);
+            for (int n = 0; n < len; n++)
+            {
+                diff = fmax(diff, fabs(refBuf[v][n] - bankBuf[v][n]));
+            }
+        }
+    }
+
+    printf("%d voices x %d samples, %d lanes (ML_SIMD %d)\n", VOICES, BLOCK_LEN, FILTER_BANK_LANES, ML_SIMD);
+    printf("largest difference to Filter_Process_Buffer: %g\n", diff);
+
+    const double single = Measure([&]
+    {
+        for (int v = 0; v < VOICES; v++)
+        {
+            Filter_Process_Buffer(refBuf[v], &proc[v], BLOCK_LEN);
+        }
+    });
+    const double bankUs = Measure([&] { FilterBank_Process(&bank, signal, BLOCK_LEN); });
+    const double groupUs = Measure([&]
+    {
+        for (int g = 0; g < FILTER_BANK_GROUPS; g++)
+        {
+            FilterBank_ProcessGroup(&bank, g, interleaved, BLOCK_LEN);
+        }
+    });
+
+    printf("Filter_Process_Buffer per voice %7.2f us\n", single);
+    printf("FilterBank_Process              %7.2f us\n", bankUs);
+    printf("FilterBank_ProcessGroup         %7.2f us\n", groupUs);
+
+    const bool ok = diff < DIFF_MAX;
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/*
+ * host test of the fixed point biquad
+ *
+ * - error of FilterFix_Process_Buffer against the same quantized coefficients in double,
+ *   rounded and noise shaped, full band and low passed (where the shaped noise is removed)
+ * - time per sample against the float Filter_Process_Buffer
+ *
+ * the host only shows the ratio, the cycle counts targeted on RP2040/SAMD21 are documented in ml_filter.cpp
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src filter_fix_bench.cpp ../../src/ml_filter.cpp -o filter_fix_bench
+ */
+
+
+#include <ml_filter.h>
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define SIGNAL_LEN  (48000 * 4)
+#define RUNS        20
+#define ERROR_DB_MAX    -30.0
+
+
+static Q1_14 input[SIGNAL_LEN];
+static Q1_14 outFix[SIGNAL_LEN];
+static float outFloat[SIGNAL_LEN];
+static double reference[SIGNAL_LEN];
+
+
+/*
+ * error relative to the signal in dB, only the second half is used to skip the transient
+ */
+static void Error(const struct filterFixCoeffT *fixC, bool noiseShaping, double *errDb, double *errLowDb)
+{
+    for (int n = 0; n < SIGNAL_LEN; n++)
+    {
+        outFix[n] = input[n];
+    }
+
+    struct filterFixProcT proc;
+    FilterFix_Init(&proc, fixC, noiseShaping);
+    FilterFix_Process_Buffer(outFix, &proc, SIGNAL_LEN);
+
+    double err = 0, sig = 0, errLow = 0, low = 0;
+    for (int n = SIGNAL_LEN / 2; n < SIGNAL_LEN; n++)
+    {
+        const double e = outFix[n].s16 - reference[n];
+        err += e * e;
+        sig += reference[n] * reference[n];
+        /* one pole low pass at about 8 Hz */
+        low = 0.999 * low + 0.001 * e;
+        errLow += low * low;
+    }
+
+    *errDb = 10.0 * log10(err / sig);
+    *errLowDb = 10.0 * log10(errLow / sig);
+}
+
+int main()
+{
+    /* 30 Hz + 3 kHz at -6 dBFS */
+    for (int n = 0; n < SIGNAL_LEN; n++)
+    {
+        input[n].s16 = (int16_t)lrint(0.25 * 16384.0 * (sin(2.0 * M_PI * 30.0 / 48000.0 * n) + sin(2.0 * M_PI * 3000.0 / 48000.0 * n)));
+    }
+
+    bool ok = true;
+
+    printf("cutoff  error rounded / low passed   error noise shaped / low passed\n");
+
+    const float cutoff[] = {0.2f, 0.5f, 0.8f};
+    for (int c = 0; c < 3; c++)
+    {
+        struct filterCoeffT floatC;
+        Filter_Calculate(cutoff[c], 2.0f, &floatC);
+        struct filterFixCoeffT fixC;
+        FilterFix_SetCoeff(&fixC, &floatC);
+
+        /* the reference uses the quantized coefficients, only the arithmetic is compared */
+        const double b0 = fixC.b[0] / 16384.0, b1 = fixC.b[1] / 16384.0, b2 = fixC.b[2] / 16384.0;
+        const double a1 = fixC.a[0] / 16384.0, a2 = fixC.a[1] / 16384.0;
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (int n = 0; n < SIGNAL_LEN; n++)
+        {
+            const double x0 = input[n].s16;
+            const double y = b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y;
+            reference[n] = y;
+        }
+
+        double errR, errRLow, errS, errSLow;
+        Error(&fixC, false, &errR, &errRLow);
+        Error(&fixC, true, &errS, &errSLow);
+        printf("%6.1f  %8.1f dB / %6.1f dB %18.1f dB / %6.1f dB\n", cutoff[c], errR, errRLow, errS, errSLow);
+
+        /* noise shaping moves the error away from low frequencies */
+        ok = ok && (errR < ERROR_DB_MAX) && (errS < ERROR_DB_MAX) && (errSLow < errRLow);
+    }
+
+    struct filterCoeffT floatC;
+    Filter_Calculate(0.5f, 1.0f, &floatC);
+    struct filterFixCoeffT fixC;
+    FilterFix_SetCoeff(&fixC, &floatC);
+    struct filterFixProcT fixP;
+    FilterFix_Init(&fixP, &fixC, true);
+    struct filterProcT floatP;
+    Filter_Init(&floatP, &floatC);
+
+    for (int n = 0; n < SIGNAL_LEN; n++)
+    {
+        outFix[n] = input[n];
+        outFloat[n] = input[n].s16 / 16384.0f;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; i++)
+    {
+        FilterFix_Process_Buffer(outFix, &fixP, SIGNAL_LEN);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; i++)
+    {
+        Filter_Process_Buffer(outFloat, &floatP, SIGNAL_LEN);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    printf("FilterFix_Process_Buffer %.2f ns/sample, Filter_Process_Buffer %.2f ns/sample\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)RUNS * SIGNAL_LEN),
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)RUNS * SIGNAL_LEN));
+
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/*
+ * host test of ml_trig.h and Filter_Calculate
+ *
+ * - maximum error of ml_sin_pi, ml_cos_pi and ml_tan_pi against the double precision functions
+ * - maximum difference of the magnitude response of Filter_Calculate against the RBJ low pass
+ *   designed in double precision, checked where the exact gain is above -60 dB
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src filter_response.cpp ../../src/ml_filter.cpp -o filter_response
+ */
+
+
+#include <ml_filter.h>
+#include <ml_trig.h>
+
+#include <stdio.h>
+#include <math.h>
+#include <complex>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define TRIG_ERROR_MAX      2.5e-7
+#define RESPONSE_DB_MAX     0.1
+
+
+static double Magnitude(const double *b, const double *a, double w)
+{
+    const std::complex<double> z1 = std::polar(1.0, -w);
+    const std::complex<double> z2 = z1 * z1;
+    return std::abs((b[0] + b[1] * z1 + b[2] * z2) / (1.0 + a[0] * z1 + a[1] * z2));
+}
+
+static void TrigError(double *errSin, double *errCos, double *errTan)
+{
+    *errSin = 0;
+    *errCos = 0;
+    *errTan = 0;
+
+    for (int i = -4000000; i <= 4000000; i++)
+    {
+        const float x = i * 1e-6f;
+        *errSin = fmax(*errSin, fabs(ml_sin_pi(x) - sin(M_PI * (double)x)));
+        *errCos = fmax(*errCos, fabs(ml_cos_pi(x) - cos(M_PI * (double)x)));
+        if ((x != 0.0f) && (fabsf(x) <= 0.49f))
+        {
+            *errTan = fmax(*errTan, fabs(ml_tan_pi(x) / tan(M_PI * (double)x) - 1.0));
+        }
+    }
+}
+
+static void ResponseError(double *errCoef, double *errDb)
+{
+    *errCoef = 0;
+    *errDb = 0;
+
+    for (int i = 0; i <= 20000; i++)
+    {
+        const float c = 0.14f + 0.86f * i / 20000.0f;
+        const float reso = 0.5f + 4.0f * (i % 7) / 6.0f;
+        struct filterCoeffT fc;
+        Filter_Calculate(c, reso, &fc);
+
+        /* same mapping of the cutoff as Filter_Calculate, calculated in double */
+        double omega = (double)c * c * c;
+        omega = (omega < 0.0025) ? 0.0025 : ((omega > 1.0) ? 1.0 : omega);
+        const double w = M_PI * omega;
+        const double alpha = sin(w) / (2.0 * reso);
+        const double a0 = 1.0 + alpha;
+        const double b[3] = {(1.0 - cos(w)) / 2.0 / a0, (1.0 - cos(w)) / a0, (1.0 - cos(w)) / 2.0 / a0};
+        const double a[2] = {-2.0 * cos(w) / a0, (1.0 - alpha) / a0};
+        const double bf[3] = {fc.bNorm[0], fc.bNorm[1], fc.bNorm[2]};
+        const double af[2] = {fc.aNorm[0], fc.aNorm[1]};
+
+        for (int k = 0; k < 3; k++)
+        {
+            *errCoef = fmax(*errCoef, fabs(bf[k] - b[k]));
+        }
+        for (int k = 0; k < 2; k++)
+        {
+            *errCoef = fmax(*errCoef, fabs(af[k] - a[k]));
+        }
+
+        /* the response at nyquist is not defined well enough for a relative comparison */
+        if (omega >= 0.999)
+        {
+            continue;
+        }
+
+        for (int f = 1; f < 256; f++)
+        {
+            const double wf = M_PI * f / 256.0;
+            const double mag = Magnitude(b, a, wf);
+            if (mag < 1e-3)
+            {
+                continue;
+            }
+            *errDb = fmax(*errDb, fabs(20.0 * log10(Magnitude(bf, af, wf) / mag)));
+        }
+    }
+}
+
+int main()
+{
+    double errSin, errCos, errTan;
+    TrigError(&errSin, &errCos, &errTan);
+    printf("ml_sin_pi %.3g, ml_cos_pi %.3g (-4 .. 4), ml_tan_pi relative %.3g (up to 0.49)\n", errSin, errCos, errTan);
+
+    double errCoef, errDb;
+    ResponseError(&errCoef, &errDb);
+    printf("Filter_Calculate: max coefficient error %.3g, max response error %.4f dB\n", errCoef, errDb);
+
+    volatile float sink = 0;
+    struct filterCoeffT fc;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++)
+    {
+        Filter_Calculate(0.2f + (i & 1023) * 0.0007f, 1.0f, &fc);
+        sink = sink + fc.coef[0];
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / 1e6;
+    printf("Filter_Calculate: %.1f ns per call\n", ns);
+
+    const bool ok = (errSin < TRIG_ERROR_MAX) && (errCos < TRIG_ERROR_MAX) && (errTan < TRIG_ERROR_MAX) && (errDb < RESPONSE_DB_MAX);
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
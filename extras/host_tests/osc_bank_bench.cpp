@@ -0,0 +1,157 @@
+/*
+ * host benchmark of the oscillator voice bank
+ *
+ * renders 64 voices in blocks of 48 samples with
+ * - the per voice loop of the previous OscProcess (copied below as reference)
+ * - OscProcess, the compatibility wrapper which loads the voices into lane groups
+ * - OscBank_Process
+ * and prints the rendered voice-samples per second and the largest difference to the reference
+ *
+ * g++ -O2 -std=gnu++14 -DARDUINO=10800 -I stub -I ../../src osc_bank_bench.cpp ../../src/ml_osc.cpp ../../src/ml_lut.cpp -o osc_bank_bench
+ * add -mavx2 -mfma for the AVX2 kernel or -U__SSE2__ for the scalar one (SSE2 is the default on x86-64)
+ */
+
+
+#include <ml_osc.h>
+#include <ml_waveform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define VOICES      64
+#define BLOCK_LEN   48
+#define BLOCKS      20000
+#define DIFF_MAX    1e-3
+
+
+static float sineTable[WAVEFORM_CNT];
+static float sawTable[WAVEFORM_CNT];
+
+
+/*
+ * the per sample loop of OscProcessSingle before the voice bank was added
+ */
+static void OscProcessSingleRef(oscillatorT *osc, uint32_t len)
+{
+    for (uint32_t n = 0U; n < len; n++)
+    {
+        osc->samplePos += (uint32_t)((*osc->cfg->pitchMultiplier) * ((float)osc->addVal) * osc->cfg->pitchOctave * osc->cfg->pitch * *osc->pitchMod);
+        uint32_t samplePos = osc->samplePos;
+        float morphMod = osc->cfg->morphWaveForm[WAVEFORM_I(osc->samplePos)];
+        morphMod *= ((float)89478480);
+        morphMod *= (*osc->cfg->morph) * 64;
+        samplePos += morphMod;
+        float sig = osc->cfg->selectedWaveForm[WAVEFORM_I(samplePos)];
+        sig *= osc->cfg->volume;
+        osc->dest[0][n] += sig;
+        osc->dest[1][n] += sig;
+    }
+}
+
+static void OscProcessRef(oscillatorT *osc, int cnt, uint32_t len)
+{
+    for (int i = 0; i < cnt; i++)
+    {
+        OscProcessSingleRef(&osc[i], len);
+    }
+}
+
+template<typename F>
+static void Measure(const char *name, F render)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        render();
+    }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("%-18s %8.1f M voice-samples/s\n", name, (double)BLOCKS * BLOCK_LEN * VOICES / s / 1e6);
+}
+
+int main()
+{
+    for (int i = 0; i < WAVEFORM_CNT; i++)
+    {
+        sineTable[i] = sinf(2.0f * (float)M_PI * i / WAVEFORM_CNT);
+        sawTable[i] = 2.0f * i / WAVEFORM_CNT - 1.0f;
+    }
+
+    static float pitchMod = 1.0f;
+    static float morph = 0.01f;
+    static float mul = 1.0f;
+
+    struct synth_osc_cfg_s cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.pitchOctave = 1;
+    cfg.pitchMultiplier = &mul;
+    cfg.volume = 0.1f;
+    cfg.pitch = 1.0f;
+    cfg.selectedWaveForm = sawTable;
+    cfg.morphWaveForm = sineTable;
+    cfg.morph = &morph;
+    cfg.generator = OSC_GENERATOR_TABLE;
+    cfg.pulseWidth = 0.5f;
+
+    static float refL[BLOCK_LEN], refR[BLOCK_LEN];
+    static float wrapL[BLOCK_LEN], wrapR[BLOCK_LEN];
+    static float bankL[BLOCK_LEN], bankR[BLOCK_LEN];
+
+    static oscillatorT ref[VOICES], wrap[VOICES];
+    static struct oscBankT bank;
+    memset(ref, 0, sizeof(ref));
+    OscBank_Init(&bank);
+
+    for (int v = 0; v < VOICES; v++)
+    {
+        ref[v].cfg = &cfg;
+        ref[v].pitchMod = &pitchMod;
+        ref[v].addVal = 1000000 + v * 777777;
+        ref[v].dest[0] = refL;
+        ref[v].dest[1] = refR;
+        wrap[v] = ref[v];
+        wrap[v].dest[0] = wrapL;
+        wrap[v].dest[1] = wrapR;
+        OscBank_SetVoice(&bank, v, &cfg, ref[v].addVal, &pitchMod);
+    }
+
+    /* the same signal from all three versions */
+    double diff = 0;
+    for (int b = 0; b < 200; b++)
+    {
+        memset(refL, 0, sizeof(refL));
+        memset(refR, 0, sizeof(refR));
+        memset(wrapL, 0, sizeof(wrapL));
+        memset(wrapR, 0, sizeof(wrapR));
+        memset(bankL, 0, sizeof(bankL));
+        memset(bankR, 0, sizeof(bankR));
+
+        OscProcessRef(ref, VOICES, BLOCK_LEN);
+        OscProcess(wrap, VOICES, BLOCK_LEN);
+        OscBank_Process(&bank, bankL, bankR, BLOCK_LEN);
+
+        for (int n = 0; n < BLOCK_LEN; n++)
+        {
+            diff = fmax(diff, fabs(refL[n] - wrapL[n]));
+            diff = fmax(diff, fabs(refR[n] - wrapR[n]));
+            diff = fmax(diff, fabs(refL[n] - bankL[n]));
+            diff = fmax(diff, fabs(refR[n] - bankR[n]));
+        }
+    }
+
+    printf("%d voices, %d samples per block, ML_SIMD %d with %d lanes\n", VOICES, BLOCK_LEN, ML_SIMD, ML_SIMD_LANES);
+    printf("largest difference to the reference: %g\n", diff);
+
+    Measure("previous loop", [&] { OscProcessRef(ref, VOICES, BLOCK_LEN); });
+    Measure("OscProcess", [&] { OscProcess(wrap, VOICES, BLOCK_LEN); });
+    Measure("OscBank_Process", [&] { OscBank_Process(&bank, bankL, bankR, BLOCK_LEN); });
+
+    const bool ok = diff < DIFF_MAX;
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/*
+ * host test of the PolyBLEP / PolyBLAMP generators against the table path
+ *
+ * - alias level: power outside of the harmonics relative to the power of the harmonics,
+ *   measured with a windowed DFT of 8192 samples at 48 kHz
+ * - speed: voice-samples per second with 64 voices in blocks of 48 samples
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src osc_blep_alias.cpp ../../src/ml_osc.cpp ../../src/ml_lut.cpp -o osc_blep_alias
+ */
+
+
+#include <ml_osc.h>
+#include <ml_waveform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define SAMPLE_RATE 48000.0f
+#define DFT_LEN     8192
+#define VOICES      64
+#define BLOCK_LEN   48
+#define BLOCKS      20000
+
+
+static float sineTable[WAVEFORM_CNT];
+static float sawTable[WAVEFORM_CNT];
+static float sqrTable[WAVEFORM_CNT];
+static struct oscMipMapT sawMipMap;
+
+static float outL[DFT_LEN];
+static float outR[DFT_LEN];
+static double window[DFT_LEN];
+static double cosTable[DFT_LEN];
+static double sinTable[DFT_LEN];
+
+
+static uint32_t AddVal(float freq)
+{
+    return (uint32_t)(freq / SAMPLE_RATE * 4294967296.0);
+}
+
+static void Render(struct synth_osc_cfg_s *cfg, float freq)
+{
+    static float pitchMod = 1.0f;
+    oscillatorT osc;
+    memset(&osc, 0, sizeof(osc));
+    osc.cfg = cfg;
+    osc.pitchMod = &pitchMod;
+    osc.addVal = AddVal(freq);
+
+    memset(outL, 0, sizeof(outL));
+    memset(outR, 0, sizeof(outR));
+
+    for (int b = 0; b < DFT_LEN / 64; b++)
+    {
+        osc.dest[0] = &outL[b * 64];
+        osc.dest[1] = &outR[b * 64];
+        OscProcess(&osc, 1, 64);
+    }
+}
+
+/*
+ * every bin closer than 3 bins to a harmonic counts as harmonic, the rest as alias
+ */
+static double AliasDb(struct synth_osc_cfg_s *cfg, float freq)
+{
+    Render(cfg, freq);
+
+    const double f0 = (double)AddVal(freq) / 4294967296.0 * DFT_LEN;
+    double harm = 0;
+    double rest = 0;
+
+    for (int k = 1; k < DFT_LEN / 2; k++)
+    {
+        double re = 0;
+        double im = 0;
+        for (int n = 0; n < DFT_LEN; n++)
+        {
+            const int i = (k * n) & (DFT_LEN - 1);
+            re += window[n] * outL[n] * cosTable[i];
+            im += window[n] * outL[n] * sinTable[i];
+        }
+        const double p = re * re + im * im;
+        const double h = k / f0;
+        if (fabs(h - round(h)) * f0 < 3.0)
+        {
+            harm += p;
+        }
+        else
+        {
+            rest += p;
+        }
+    }
+
+    return 10.0 * log10(rest / harm);
+}
+
+static double Speed(struct synth_osc_cfg_s *cfg)
+{
+    static float pitchMod = 1.0f;
+    static oscillatorT osc[VOICES];
+    memset(osc, 0, sizeof(osc));
+
+    for (int v = 0; v < VOICES; v++)
+    {
+        osc[v].cfg = cfg;
+        osc[v].pitchMod = &pitchMod;
+        osc[v].addVal = 1000000 + v * 777777;
+        osc[v].dest[0] = outL;
+        osc[v].dest[1] = outR;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        OscProcess(osc, VOICES, BLOCK_LEN);
+    }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return (double)BLOCKS * BLOCK_LEN * VOICES / s / 1e6;
+}
+
+int main()
+{
+    for (int i = 0; i < WAVEFORM_CNT; i++)
+    {
+        sineTable[i] = sinf(2.0f * (float)M_PI * i / WAVEFORM_CNT);
+        sawTable[i] = 2.0f * i / WAVEFORM_CNT - 1.0f;
+        sqrTable[i] = (i < WAVEFORM_CNT / 2) ? 1.0f : -1.0f;
+    }
+    OscMipMap_Build(&sawMipMap, sawTable);
+
+    for (int n = 0; n < DFT_LEN; n++)
+    {
+        window[n] = 0.5 - 0.5 * cos(2.0 * M_PI * n / DFT_LEN);
+        cosTable[n] = cos(2.0 * M_PI * n / DFT_LEN);
+        sinTable[n] = sin(2.0 * M_PI * n / DFT_LEN);
+    }
+
+    static float mul = 1.0f;
+    static float morph = 0.0f;
+
+    struct synth_osc_cfg_s sawTab;
+    memset(&sawTab, 0, sizeof(sawTab));
+    sawTab.pitchOctave = 1;
+    sawTab.pitchMultiplier = &mul;
+    sawTab.volume = 1.0f;
+    sawTab.pitch = 1.0f;
+    sawTab.selectedWaveForm = sawTable;
+    sawTab.morphWaveForm = sineTable;
+    sawTab.morph = &morph;
+    sawTab.generator = OSC_GENERATOR_TABLE;
+    sawTab.pulseWidth = 0.5f;
+
+    struct synth_osc_cfg_s sawMip = sawTab;
+    sawMip.selectedMipMap = &sawMipMap;
+    struct synth_osc_cfg_s sqrTab = sawTab;
+    sqrTab.selectedWaveForm = sqrTable;
+    struct synth_osc_cfg_s sawBlep = sawTab;
+    sawBlep.generator = OSC_GENERATOR_BLEP_SAW;
+    struct synth_osc_cfg_s pulseBlep = sawTab;
+    pulseBlep.generator = OSC_GENERATOR_BLEP_PULSE;
+    pulseBlep.pulseWidth = 0.3f;
+    struct synth_osc_cfg_s triBlamp = sawTab;
+    triBlamp.generator = OSC_GENERATOR_BLAMP_TRI;
+
+    struct
+    {
+        const char *name;
+        struct synth_osc_cfg_s *cfg;
+    } const gen[] =
+    {
+        {"saw table", &sawTab},
+        {"saw mipmap", &sawMip},
+        {"saw blep", &sawBlep},
+        {"sqr table", &sqrTab},
+        {"pulse blep", &pulseBlep},
+        {"tri blamp", &triBlamp},
+    };
+    const int genCnt = sizeof(gen) / sizeof(gen[0]);
+    const float freq[] = {440.0f, 1760.0f, 7040.0f};
+
+    bool ok = true;
+
+    printf("alias level in dB\n%8s", "");
+    for (int g = 0; g < genCnt; g++)
+    {
+        printf(" %11s", gen[g].name);
+    }
+    printf("\n");
+
+    for (int f = 0; f < 3; f++)
+    {
+        double db[genCnt];
+        printf("%5.0f Hz", freq[f]);
+        for (int g = 0; g < genCnt; g++)
+        {
+            db[g] = AliasDb(gen[g].cfg, freq[f]);
+            printf(" %11.1f", db[g]);
+        }
+        printf("\n");
+
+        /* the generators must be clearly cleaner than the plain tables */
+        ok = ok && (db[2] < db[0] - 10.0) && (db[4] < db[3] - 10.0);
+    }
+
+    printf("\nM voice-samples/s, %d voices\n", VOICES);
+    for (int g = 0; g < genCnt; g++)
+    {
+        printf("%-11s %6.1f\n", gen[g].name, Speed(gen[g].cfg));
+    }
+
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
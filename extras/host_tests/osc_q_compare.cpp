@@ -0,0 +1,139 @@
+/*
+ * host test of the fixed point oscillator
+ *
+ * - maximum difference of OscProcessQ against the float OscProcess with the same settings
+ * - a pitch and morph change at the middle of the run checks the ramp of the control values
+ * - a table with samples close to 2.0 and a high morph depth checks the range of the morph product,
+ *   build with -fsanitize=undefined to get the integer overflow reported
+ *
+ * g++ -O2 -std=gnu++11 -DARDUINO=10800 -I stub -I ../../src osc_q_compare.cpp ../../src/ml_osc.cpp ../../src/ml_lut.cpp -o osc_q_compare
+ */
+
+
+#include <ml_osc.h>
+#include <ml_lut.h>
+
+#include <stdio.h>
+#include <math.h>
+
+
+Stream Serial;
+
+
+#define BLOCK_LEN   64
+#define BLOCK_CNT   200
+#define DIFF_MAX    5e-3
+/*
+ * the morph table is read without interpolation in both versions, at a high depth the small phase difference
+ * after a pitch change can select the neighbour entry which moves the read position by several entries
+ */
+#define DIFF_MAX_HIGH_MORPH 5e-2
+
+
+static float sine[WAVEFORM_CNT];
+static float waveForm[WAVEFORM_CNT];
+static int16_t waveFormQ[WAVEFORM_CNT];
+
+
+/*
+ * runs both oscillators over BLOCK_CNT blocks, the pitch and morph change to the second values at half of the run
+ */
+static double MaxDiff(float gain, float morph1, float morph2, float pitch1, float pitch2)
+{
+    for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+    {
+        sine[n] = mlLutSine.v[n];
+        waveForm[n] = gain * mlLutSine.v[n];
+    }
+    OscConvertWaveformQ(waveForm, waveFormQ);
+
+    float pitchMod = pitch1;
+    float multiplier = 1.0f;
+    float morph = morph1;
+
+    struct synth_osc_cfg_s cfg = {};
+    cfg.selectedWaveForm = sine;
+    cfg.morphWaveForm = waveForm;
+    cfg.selectedWaveFormQ = mlLutSineQ.v;
+    cfg.morphWaveFormQ = waveFormQ;
+    cfg.pitchMultiplier = &multiplier;
+    cfg.morph = &morph;
+    cfg.pitchOctave = 1.0f;
+    cfg.pitch = 1.0f;
+    cfg.volume = 0.5f;
+
+    float left[BLOCK_LEN], right[BLOCK_LEN];
+    Q1_14 leftQ[BLOCK_LEN], rightQ[BLOCK_LEN];
+
+    oscillatorT osc = {};
+    osc.dest[0] = left;
+    osc.dest[1] = right;
+    osc.addVal = (uint32_t)(440.0 / 44100.0 * 4294967296.0);
+    osc.pitchMod = &pitchMod;
+    osc.cfg = &cfg;
+
+    oscillatorQT oscQ = {};
+    oscQ.dest[0] = leftQ;
+    oscQ.dest[1] = rightQ;
+    oscQ.addVal = osc.addVal;
+    oscQ.pitchMod = &pitchMod;
+    oscQ.cfg = &cfg;
+
+    double maxDiff = 0.0;
+    for (int b = 0; b < BLOCK_CNT; b++)
+    {
+        if (b == BLOCK_CNT / 2)
+        {
+            pitchMod = pitch2;
+            morph = morph2;
+        }
+
+        for (int n = 0; n < BLOCK_LEN; n++)
+        {
+            left[n] = right[n] = 0.0f;
+            leftQ[n].s16 = rightQ[n].s16 = 0;
+        }
+
+        OscProcess(&osc, 1, BLOCK_LEN);
+        OscProcessQ(&oscQ, 1, BLOCK_LEN);
+
+        for (int n = 0; n < BLOCK_LEN; n++)
+        {
+            maxDiff = fmax(maxDiff, fabs(left[n] - leftQ[n].s16 / 16384.0));
+        }
+    }
+
+    return maxDiff;
+}
+
+int main()
+{
+    bool ok = true;
+
+    const struct
+    {
+        const char *name;
+        float gain, morph1, morph2, pitch1, pitch2;
+        double diffMax;
+    } test[] =
+    {
+        {"steady", 1.0f, 0.1f, 0.1f, 1.0f, 1.0f, DIFF_MAX},
+        {"pitch and morph change", 1.0f, 0.1f, 0.3f, 1.0f, 1.4987f, DIFF_MAX},
+        {"table near 2.0, high morph", 1.95f, 1.4f, 1.4f, 1.0f, 1.0f, DIFF_MAX},
+        {"table near 2.0, change", 1.95f, 1.2f, 1.4f, 1.0f, 0.7491f, DIFF_MAX_HIGH_MORPH},
+    };
+
+    printf("case                          max. difference\n");
+    for (unsigned t = 0; t < sizeof(test) / sizeof(test[0]); t++)
+    {
+        const double diff = MaxDiff(test[t].gain, test[t].morph1, test[t].morph2, test[t].pitch1, test[t].pitch2);
+        printf("%-30s%.6f\n", test[t].name, diff);
+        if (diff > test[t].diffMax)
+        {
+            ok = false;
+        }
+    }
+
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
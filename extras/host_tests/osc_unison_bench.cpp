@@ -0,0 +1,137 @@
+/*
+ * host benchmark of the unison oscillator
+ *
+ * renders one note with 7 detuned phases of a saw table in blocks of 64 samples with
+ * - OscUnison_Process
+ * - 7 single oscillators, one OscProcess call each (the way a sketch stacks voices)
+ * - the same 7 oscillators in one OscProcess call
+ * and prints the time per output sample, with detune and spread at 0 the unison output
+ * is compared against the level corrected sum of the stacked oscillators
+ *
+ * g++ -O2 -std=gnu++14 -DARDUINO=10800 -I stub -I ../../src osc_unison_bench.cpp ../../src/ml_osc.cpp ../../src/ml_lut.cpp -o osc_unison_bench
+ * add -mavx2 -mfma for the AVX2 kernel or -U__SSE2__ for the scalar one (SSE2 is the default on x86-64)
+ */
+
+
+#include <ml_osc.h>
+#include <ml_lut.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+
+Stream Serial;
+
+
+#define PHASES      7
+#define BLOCK_LEN   64
+#define BLOCKS      200000
+#define DIFF_MAX    1e-6
+
+
+static float sawTable[WAVEFORM_CNT];
+
+
+template<typename F>
+static void Measure(const char *name, F render)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        render();
+    }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("%-22s %6.2f ns per output sample\n", name, s / BLOCKS / BLOCK_LEN * 1e9);
+}
+
+int main()
+{
+    for (int i = 0; i < WAVEFORM_CNT; i++)
+    {
+        sawTable[i] = mlLutSaw.v[i];
+    }
+
+    static float pitchMod = 1.0f;
+    static float morph = 0.0f;
+    static float mul = 1.0f;
+
+    struct synth_osc_cfg_s cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.pitchOctave = 1;
+    cfg.pitchMultiplier = &mul;
+    cfg.volume = 0.5f;
+    cfg.pitch = 1.0f;
+    cfg.selectedWaveForm = sawTable;
+    cfg.morphWaveForm = sawTable;
+    cfg.morph = &morph;
+
+    static float uniL[BLOCK_LEN], uniR[BLOCK_LEN];
+    static float stackL[BLOCK_LEN], stackR[BLOCK_LEN];
+
+    static struct oscUnisonT uni;
+    memset(&uni, 0, sizeof(uni));
+    uni.dest[0] = uniL;
+    uni.dest[1] = uniR;
+    uni.addVal = (uint32_t)(220.0 / 44100.0 * 4294967296.0);
+    uni.pitchMod = &pitchMod;
+    uni.cfg = &cfg;
+    OscUnison_SetVoices(&uni, PHASES, 0.0f, 0.0f);
+    OscUnison_ResetPhase(&uni);
+
+    static oscillatorT stack[PHASES];
+    memset(stack, 0, sizeof(stack));
+    for (int v = 0; v < PHASES; v++)
+    {
+        stack[v].cfg = &cfg;
+        stack[v].pitchMod = &pitchMod;
+        stack[v].addVal = (uint32_t)(uni.addVal * uni.detuneMul[v]);
+        stack[v].samplePos = uni.samplePos[v];
+        stack[v].dest[0] = stackL;
+        stack[v].dest[1] = stackR;
+    }
+
+    /* without detune and spread each phase has the same gain */
+    double diff = 0;
+    for (int b = 0; b < 200; b++)
+    {
+        memset(uniL, 0, sizeof(uniL));
+        memset(uniR, 0, sizeof(uniR));
+        memset(stackL, 0, sizeof(stackL));
+        memset(stackR, 0, sizeof(stackR));
+
+        OscUnison_Process(&uni, 1, BLOCK_LEN);
+        OscProcess(stack, PHASES, BLOCK_LEN);
+
+        for (int n = 0; n < BLOCK_LEN; n++)
+        {
+            diff = fmax(diff, fabs(uniL[n] - stackL[n] * uni.gainL[0]));
+            diff = fmax(diff, fabs(uniR[n] - stackR[n] * uni.gainR[0]));
+        }
+    }
+
+    printf("%d phases, %d samples per block, ML_SIMD %d with %d lanes\n", PHASES, BLOCK_LEN, ML_SIMD, ML_SIMD_LANES);
+    printf("largest difference to the stacked oscillators: %g\n", diff);
+
+    /* the timed versions use the detune and spread of a typical supersaw */
+    OscUnison_SetVoices(&uni, PHASES, 0.2f, 0.8f);
+    for (int v = 0; v < PHASES; v++)
+    {
+        stack[v].addVal = (uint32_t)(uni.addVal * uni.detuneMul[v]);
+    }
+
+    Measure("OscUnison_Process", [&] { OscUnison_Process(&uni, 1, BLOCK_LEN); });
+    Measure("7 OscProcess calls", [&]
+    {
+        for (int v = 0; v < PHASES; v++)
+        {
+            OscProcess(&stack[v], 1, BLOCK_LEN);
+        }
+    });
+    Measure("one OscProcess call", [&] { OscProcess(stack, PHASES, BLOCK_LEN); });
+
+    const bool ok = diff < DIFF_MAX;
+    printf("%s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
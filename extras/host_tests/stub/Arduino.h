@@ -0,0 +1,44 @@
+/*
+ * minimal replacement of Arduino.h to compile parts of the library on a PC
+ * used by the programs in extras/host_tests only
+ */
+
+#ifndef HOST_TESTS_STUB_ARDUINO_H_
+#define HOST_TESTS_STUB_ARDUINO_H_
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <time.h>
+
+
+#define PROGMEM
+
+class Stream
+{
+public:
+    int printf(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int ret = vprintf(format, args);
+        va_end(args);
+        return ret;
+    }
+};
+
+extern Stream Serial;
+
+static inline uint32_t micros(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(t.tv_sec * 1000000ULL + t.tv_nsec / 1000);
+}
+
+
+#endif /* HOST_TESTS_STUB_ARDUINO_H_ */
@@ -40,18 +40,10 @@
 #include <ml_arp.h>
 
 
-#define ARP_STEPS 16
-
-enum arpState_e
-{
-    arp_idle,
-    arp_acti,
-    arp_rec,
-};
-
-static uint8_t arpSelected = 0; /*!< selected riff, 0 means no playback */
-
-uint8_t arp[7][ARP_STEPS] =
+/*
+ * default sequences, each instance starts with a copy which can be replaced by recording
+ */
+static const uint8_t arpSeqDefault[ARP_SEQ_CNT][ARP_STEPS] =
 {
     { 12 - 12, 12 - 12, 12, 12, 12 + 12, 12, 12, 12 + 15, 12 - 12, 12 - 12, 12, 12, 12 + 12, 12, 12, 12 + 15}, /* Drax Ltd. II - Amphetamine */
     {0, 12, 24, 0, 12, 24, 0, 12, 24, 0, 12, 24, 0, 12, 24, 36}, /* popcorn bass riff */
@@ -63,34 +55,25 @@ uint8_t arp[7][ARP_STEPS] =
     {0, 12, 12, 0, 12, 12, 0, 0, 12, 12, 0, 10, 0, 10, 11, 12},   /* my first own */
 };
 
-static uint32_t arp_sample_rate = 6;
-static uint8_t arpNote = 0xFF;
-static uint64_t arp_cnt = 0;
-static uint64_t arp_act = 0;
-static uint32_t arp_pos = 0;
-static uint32_t arp_key = 0;
+/*
+ * default instance used by the Arp_ functions
+ */
+static ML_Arp arpDefault;
+
 
-static struct
+ML_Arp::ML_Arp()
 {
-    arpState_e arpState;
-    uint8_t activeCh;
-    uint8_t activeNote;
-    uint32_t tempo;
-    uint32_t gate;
-    float f_gate;
-    uint8_t rxCh;
-} arpModule =
+    memcpy(arp, arpSeqDefault, sizeof(arp));
+}
+
+void ML_Arp::setCallbacks(void (*noteOnFn)(uint8_t ch, uint8_t note, float vel), void (*noteOffFn)(uint8_t ch, uint8_t note), void (*stepFn)(uint8_t step))
 {
-    arp_idle,
-    0xFF,
-    0xFF,
-    (uint32_t)(arp_sample_rate * (1.0f - 0.875f)),
-    (uint32_t)(arp_sample_rate * (1.0f - 0.875f) * 0.5f),
-    0.5f,
-    0,
-};
+    cbNoteOn = noteOnFn;
+    cbNoteOff = noteOffFn;
+    cbStep = stepFn;
+}
 
-void Arp_Init(uint32_t sample_rate)
+void ML_Arp::init(uint32_t sample_rate)
 {
     arp_sample_rate = sample_rate;
 
@@ -98,10 +81,10 @@ void Arp_Init(uint32_t sample_rate)
     arpModule.gate = (uint32_t)(arp_sample_rate * (1.0f - 0.875f) * 0.5f);
     arpModule.arpState = arp_idle;
 
-    Arp_Tempo(0, 0.5f);
+    setTempo(0.5f);
 }
 
-void Arp_Process(uint64_t elapsed_ms)
+void ML_Arp::process(uint64_t elapsed_ms)
 {
     if (arpModule.arpState == arp_acti)
     {
@@ -118,13 +101,13 @@ void Arp_Process(uint64_t elapsed_ms)
             {
                 if ((voice->noteCount > 0) && (arp_sld[arpSelected][arp_act] == 0))
                 {
-                    Arp_Cb_NoteOff(0, voice->activeNote);
+                    cbNoteOff(0, voice->activeNote);
                 }
             }
 #else
             if (arpNote != 0xFF)
             {
-                Arp_Cb_NoteOff(arpModule.activeCh, arpModule.activeNote);
+                cbNoteOff(arpModule.activeCh, arpModule.activeNote);
             }
 #endif
         }
@@ -135,25 +118,25 @@ void Arp_Process(uint64_t elapsed_ms)
             if (arpNote != 0xFF)
             {
 #if 1
-                Arp_Cb_NoteOff(arpModule.activeCh, arpModule.activeNote);
+                cbNoteOff(arpModule.activeCh, arpModule.activeNote);
 #else
                 /*
                  * stop note to avoid portamento
                  */
                 if ((voice->noteCount > 0) && (arp_sld[arpSelected][arp_act] == 1))
                 {
-                    Arp_Cb_NoteOff(0, voice->activeNote);
+                    cbNoteOff(0, voice->activeNote);
                 }
 #endif
                 arpModule.activeNote = arpNote + arp[arpSelected][arp_pos];
-                Arp_Cb_NoteOn(arpModule.activeCh, arpModule.activeNote, 1);
+                cbNoteOn(arpModule.activeCh, arpModule.activeNote, 1);
 #if 0
                 /*
                  * note off after note on to get portamento effect
                  */
                 if ((voice->noteCount > 1) && (arp_sld[arpSelected][arp_act] == 2))
                 {
-                    Arp_Cb_NoteOff(0, voice->oldNote);
+                    cbNoteOff(0, voice->oldNote);
                 }
 #endif
                 arp_act = arp_pos;
@@ -162,20 +145,20 @@ void Arp_Process(uint64_t elapsed_ms)
                 {
                     arp_pos = 0;
                 }
-                Arp_Cb_Step(arp_pos);
+                cbStep(arp_pos);
             }
         }
     }
 }
 
-void Arp_Reset(void)
+void ML_Arp::reset(void)
 {
     arp_pos = 0;
     arp_act = sizeof(arp) - 1;
     arp_cnt = arpModule.tempo;
 }
 
-void Arp_NoteOn(uint8_t ch, uint8_t note, float vel)
+void ML_Arp::noteOn(uint8_t ch, uint8_t note, float vel)
 {
     if ((arpModule.arpState == arp_acti) && (ch == arpModule.rxCh))
     {
@@ -191,7 +174,7 @@ void Arp_NoteOn(uint8_t ch, uint8_t note, float vel)
     }
     else if (arpModule.arpState == arp_rec)
     {
-        Arp_Cb_NoteOn(ch, note, vel);
+        cbNoteOn(ch, note, vel);
 
         arp[arpSelected][arp_pos] = note;
         arp_pos++;
@@ -209,33 +192,33 @@ void Arp_NoteOn(uint8_t ch, uint8_t note, float vel)
             {
                 arp[arpSelected][i] -= arpMin;
             }
-            Arp_Active();
+            active();
         }
     }
     else
     {
-        Arp_Cb_NoteOn(ch, note, vel);
+        cbNoteOn(ch, note, vel);
     }
 }
 
-void Arp_NoteOff(uint8_t ch, uint8_t note)
+void ML_Arp::noteOff(uint8_t ch, uint8_t note)
 {
     if ((arpModule.arpState == arp_acti) && (arpModule.rxCh == ch))
     {
         if (arp_key == 1)
         {
-            Arp_Cb_NoteOff(arpModule.activeCh, arpModule.activeNote);
+            cbNoteOff(arpModule.activeCh, arpModule.activeNote);
             arpNote = 0xFF;
         }
         arp_key --;
     }
     else
     {
-        Arp_Cb_NoteOff(ch, note);
+        cbNoteOff(ch, note);
     }
 }
 
-void Synth_ArpActive(float value)
+void ML_Arp::setActive(float value)
 {
     uint8_t val8 = (value * 5.0f);
     if (val8 == 0)
@@ -249,7 +232,7 @@ void Synth_ArpActive(float value)
     }
 }
 
-void Arp_SelectSequence(uint8_t seq, float value)
+void ML_Arp::selectSequence(uint8_t seq, float value)
 {
     if (value > 0)
     {
@@ -257,43 +240,39 @@ void Arp_SelectSequence(uint8_t seq, float value)
         {
             arpSelected = seq;
             arpModule.arpState = arp_acti;
-            Arp_Status_ValueChangedInt("ArpSeq", seq);
         }
         else
         {
-            Arp_Idle();
+            idle();
         }
     }
 }
 
-void Arp_StartRecord(uint8_t seq __attribute__((unused)), float value __attribute__((unused)))
+void ML_Arp::startRecord(void)
 {
-    Arp_Status_LogMessage("Arp Record");
     arpModule.arpState = arp_rec;
     arp_pos = 0; /* start with first note when doing a record */
     arp_key = 0;
 }
 
-void Arp_Idle()
+void ML_Arp::idle(void)
 {
-    Arp_Status_LogMessage("Arp Idle");
     arpModule.arpState = arp_idle;
     if (arpNote != 0xFF)
     {
-        Arp_Cb_NoteOff(arpModule.activeCh, arpModule.activeNote);
+        cbNoteOff(arpModule.activeCh, arpModule.activeNote);
     }
     arpNote = 0xFF;
     arp_key = 0;
 }
 
-void Arp_Active()
+void ML_Arp::active(void)
 {
-    Arp_Status_LogMessage("Arp active");
     arpModule.arpState = arp_acti;
     arp_key = 0;
 }
 
-void Arp_Tempo(uint8_t unused __attribute__((unused)), float value)
+void ML_Arp::setTempo(float value)
 {
     float f_tempo = ((float)arp_sample_rate);// - (value * ((float)(arp_sample_rate)));
     for (int i = 0; i < value * 8; i++)
@@ -302,18 +281,99 @@ void Arp_Tempo(uint8_t unused __attribute__((unused)), float value)
     }
     arpModule.tempo = f_tempo;
     arpModule.gate = ((float)arpModule.tempo) * arpModule.f_gate;
-    Arp_Status_ValueChangedFloat("ArpTempo", value);
 }
 
-void Arp_GateTime(uint8_t unused __attribute__((unused)), float value)
+void ML_Arp::setGateTime(float value)
 {
     arpModule.f_gate = value;
     arpModule.gate = ((float)arpModule.tempo) * arpModule.f_gate;
-    Arp_Status_ValueChangedFloat("ArpGate", arpModule.f_gate);
 }
 
-uint32_t Arp_GetPos(void)
+uint32_t ML_Arp::getPos(void)
 {
     return arp_pos;
 }
 
+/*
+ * functions of the default instance
+ */
+void Arp_Init(uint32_t sample_rate)
+{
+    arpDefault.init(sample_rate);
+}
+
+void Arp_Process(uint64_t elapsed_ms)
+{
+    arpDefault.process(elapsed_ms);
+}
+
+void Arp_Reset(void)
+{
+    arpDefault.reset();
+}
+
+void Arp_NoteOn(uint8_t ch, uint8_t note, float vel)
+{
+    arpDefault.noteOn(ch, note, vel);
+}
+
+void Arp_NoteOff(uint8_t ch, uint8_t note)
+{
+    arpDefault.noteOff(ch, note);
+}
+
+void Synth_ArpActive(float value)
+{
+    arpDefault.setActive(value);
+}
+
+void Arp_SelectSequence(uint8_t seq, float value)
+{
+    /* an invalid sequence stops the arpeggiator */
+    if ((value > 0) && (seq >= ARP_SEQ_CNT))
+    {
+        Arp_Status_LogMessage("Arp Idle");
+    }
+
+    arpDefault.selectSequence(seq, value);
+
+    if ((value > 0) && (seq < ARP_SEQ_CNT))
+    {
+        Arp_Status_ValueChangedInt("ArpSeq", seq);
+    }
+}
+
+void Arp_StartRecord(uint8_t seq __attribute__((unused)), float value __attribute__((unused)))
+{
+    Arp_Status_LogMessage("Arp Record");
+    arpDefault.startRecord();
+}
+
+void Arp_Idle(void)
+{
+    Arp_Status_LogMessage("Arp Idle");
+    arpDefault.idle();
+}
+
+void Arp_Active(void)
+{
+    Arp_Status_LogMessage("Arp active");
+    arpDefault.active();
+}
+
+void Arp_Tempo(uint8_t unused __attribute__((unused)), float value)
+{
+    arpDefault.setTempo(value);
+    Arp_Status_ValueChangedFloat("ArpTempo", value);
+}
+
+void Arp_GateTime(uint8_t unused __attribute__((unused)), float value)
+{
+    arpDefault.setGateTime(value);
+    Arp_Status_ValueChangedFloat("ArpGate", value);
+}
+
+uint32_t Arp_GetPos(void)
+{
+    return arpDefault.getPos();
+}
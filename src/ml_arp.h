@@ -72,4 +72,76 @@ void Arp_Status_ValueChangedFloat(const char *msg, float value);
 void Arp_Cb_Step(uint8_t step);
 
 
+
+#define ARP_STEPS   16
+#define ARP_SEQ_CNT 7
+
+enum arpState_e
+{
+    arp_idle,
+    arp_acti,
+    arp_rec,
+};
+
+/*
+ * one arpeggiator, notes are sent to the callbacks (Arp_Cb_NoteOn, Arp_Cb_NoteOff, Arp_Cb_Step by default)
+ * the Arp_ functions above use a default instance, only they report to Arp_Status_...
+ */
+class ML_Arp
+{
+public:
+    ML_Arp();
+    ~ML_Arp() {};
+    void init(uint32_t sample_rate);
+    void process(uint64_t elapsed_ms);
+    void reset(void);
+    void noteOn(uint8_t ch, uint8_t note, float vel);
+    void noteOff(uint8_t ch, uint8_t note);
+    void setActive(float value);
+    void selectSequence(uint8_t seq, float value);
+    void startRecord(void);
+    void idle(void);
+    void active(void);
+    void setTempo(float value);
+    void setGateTime(float value);
+    uint32_t getPos(void);
+    void setCallbacks(void (*noteOnFn)(uint8_t ch, uint8_t note, float vel), void (*noteOffFn)(uint8_t ch, uint8_t note), void (*stepFn)(uint8_t step));
+
+private:
+    void (*cbNoteOn)(uint8_t ch, uint8_t note, float vel) = Arp_Cb_NoteOn;
+    void (*cbNoteOff)(uint8_t ch, uint8_t note) = Arp_Cb_NoteOff;
+    void (*cbStep)(uint8_t step) = Arp_Cb_Step;
+
+    uint8_t arp[ARP_SEQ_CNT][ARP_STEPS];
+    uint8_t arpSelected = 0; /*!< selected riff, 0 means no playback */
+
+    uint32_t arp_sample_rate = 6;
+    uint8_t arpNote = 0xFF;
+    uint64_t arp_cnt = 0;
+    uint64_t arp_act = 0;
+    uint32_t arp_pos = 0;
+    uint32_t arp_key = 0;
+
+    struct
+    {
+        arpState_e arpState;
+        uint8_t activeCh;
+        uint8_t activeNote;
+        uint32_t tempo;
+        uint32_t gate;
+        float f_gate;
+        uint8_t rxCh;
+    } arpModule =
+    {
+        arp_idle,
+        0xFF,
+        0xFF,
+        (uint32_t)(arp_sample_rate * (1.0f - 0.875f)),
+        (uint32_t)(arp_sample_rate * (1.0f - 0.875f) * 0.5f),
+        0.5f,
+        0,
+    };
+};
+
+
 #endif /* SRC_ML_ARP_H_ */
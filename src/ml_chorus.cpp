@@ -48,8 +48,9 @@
 
 
 #include <ml_chorus.h>
-#include <ml_alg.h>
 #include <ml_status.h>
+#include <ml_lut.h>
+#include <ml_ring.h>
 
 #include <math.h>
 
@@ -60,22 +61,9 @@
 
 
 /*
- * module variables
+ * default instance used by the Chorus_ functions
  */
-static int16_t *chorusLine_l;
-
-static float chorusToMix = 0;
-static float chorusInLvl = 1.0f;
-static float chorusDepth = 0;
-static float chorusSpeed = 2.0f / 3.0f;
-static float chorusThrough = 1.0f;
-static float chorusPhaseShift = 0.5f;
-static uint32_t chorusLenMax = 0;
-static uint32_t chorusLen = 1098;
-static uint32_t chorusDelay = 0;
-static uint32_t chorusIn = 0;
-static uint32_t chorusOut = 0;
-static uint32_t chorusOut2 = 0;
+static ML_Chorus chorusDefault;
 
 
 #define SINE_BIT    11
@@ -84,31 +72,9 @@ static uint32_t chorusOut2 = 0;
 #define SINE_MASK_BIT   (32-SINE_BIT)
 #define SINE_MASK   (SINE_CNT-1)
 
-float sineLookup[SINE_CNT];
-
-struct sineL_s
-{
-    uint32_t rad;
-    uint32_t add;
-    float f;
-    float a;
-    float b;
-};
-
-struct sineL_s sinM;
-struct sineL_s sinS;
-
-static inline
-void Chorus_InitializeSineLookup()
-{
-    for (int n = 0; n < SINE_CNT; n++)
-    {
-        float rad = n;
-        rad *= 2.0f * M_PI;
-        rad /= SINE_CNT;
-        sineLookup[n] = sin(rad);
-    }
-}
+/* calculated by the compiler, placed in flash */
+static const float *const sineLookup = mlLutSine2048.v;
+static_assert(sizeof(mlLutSine2048.v) == SINE_CNT * sizeof(float), "size of mlLutSine2048 does not match SINE_CNT");
 
 static inline
 void CSineSetFrequency(struct sineL_s *sine, float frequency, float sample_rate)
@@ -148,7 +114,7 @@ void CSineInit(struct sineL_s *sine)
     CSineCalc(sine);
 }
 
-void Chorus_Init(int16_t *buffer, uint32_t len)
+void ML_Chorus::init(int16_t *buffer, uint32_t len)
 {
     chorusLine_l = buffer;
     chorusLenMax = len - 2;
@@ -158,22 +124,21 @@ void Chorus_Init(int16_t *buffer, uint32_t len)
         printf("Not enough memory available for mono chorus line!\n");
     }
 
-    Chorus_Reset();
+    reset();
 }
 
-void Chorus_Reset(void)
+void ML_Chorus::reset(void)
 {
     for (uint32_t i = 0; i < chorusLenMax; i++)
     {
         chorusLine_l[i] = 0;
     }
 
-    Chorus_InitializeSineLookup();
     CSineInit(&sinM);
     CSineInit(&sinS);
 }
 
-void Chorus_Process(float *signal_l, float *signal_r __attribute__((unused)))
+void ML_Chorus::process(float *signal_l, float *signal_r __attribute__((unused)))
 {
     chorusLine_l[chorusIn] = (((float)0x8000) * *signal_l * chorusInLvl);
 
@@ -196,38 +161,148 @@ void Chorus_Process(float *signal_l, float *signal_r __attribute__((unused)))
     }
 }
 
-void Chorus_Process_Buff(float *in, float *left, float *right, int buffLen)
+/*
+ * read positions of one modulated tap, the delay is ramped from the end of the last block to d
+ */
+void ML_Chorus::tapPositions(float *dLast, float d, uint32_t *idx, float *frac, int buffLen)
+{
+    /* keeps the linear interpolation behind the write position */
+    const float dMax = chorusLenMax - 1;
+    d = d < 1.0f ? 1.0f : (d > dMax ? dMax : d);
+
+    /* jumps which cannot be ramped (first block, changed delay) are taken immediately */
+    if (fabsf(d - *dLast) > buffLen)
+    {
+        *dLast = d;
+    }
+
+    Ring_Positions(chorusIn, chorusLenMax, *dLast, (d - *dLast) / buffLen, idx, frac, buffLen);
+    *dLast = d;
+}
+
+void ML_Chorus::process(float *in, float *left, float *right, int buffLen)
 {
     const float mult = chorusDepth * 0.5f;
 
-    for (int n = 0; n < buffLen; n++)
+    /* the modulation is calculated for the end of the block */
+    sinM.rad += sinM.add * (buffLen - 1);
+    sinS.rad += sinS.add * (buffLen - 1);
+    CSineCalc(&sinM);
+    CSineCalc(&sinS);
+
+    uint32_t idx1[buffLen], idx2[buffLen];
+    float frac1[buffLen], frac2[buffLen];
+    tapPositions(&chorusMod1, chorusDelay + mult * (1.0f - sinM.a), idx1, frac1, buffLen);
+    tapPositions(&chorusMod2, chorusDelay + mult * (1.0f - sinS.a), idx2, frac2, buffLen);
+
+    /* the write position wraps only between two runs */
+    for (int n = 0; n < buffLen;)
     {
-        CSineCalc(&sinM);
-        CSineCalc(&sinS);
+        const uint32_t run = Ring_Run(chorusIn, chorusLenMax, buffLen - n);
+        int16_t *lineIn = &chorusLine_l[chorusIn];
 
-        chorusLine_l[chorusIn] = (((float)0x4000) * in[n] * chorusInLvl);
+        for (uint32_t k = 0; k < run; k++, n++)
+        {
+            lineIn[k] = (((float)0x4000) * in[n] * chorusInLvl);
 
-        float sinV1 = mult * (1.0f - sinM.a);
-        float sinV2 = mult * (1.0f - sinS.a);
+            left[n] *= chorusThrough;
+            right[n] *= chorusThrough;
 
-        chorusOut = chorusIn + (0 + chorusLenMax - sinV1 - chorusDelay);
-        chorusOut2 = chorusIn + (0 + chorusLenMax - sinV2 - chorusDelay);
+            left[n] -= Ring_ReadLinear(chorusLine_l, chorusLenMax, idx1[n], frac1[n]) * chorusToMix / ((float)0x4000);
+            right[n] -= Ring_ReadLinear(chorusLine_l, chorusLenMax, idx2[n], frac2[n]) * chorusToMix / ((float)0x4000);
+        }
 
-        float chorusOutf = chorusIn + (0 + chorusLenMax - (uint32_t)sinV1 - chorusDelay);
-        float chorusOutf2 = chorusIn + (0 + chorusLenMax - (uint32_t)sinV2 - chorusDelay);
+        chorusIn = Ring_Wrap(chorusIn + run, chorusLenMax);
+    }
+}
 
-        left[n] *= chorusThrough;
-        right[n] *= chorusThrough;
+void ML_Chorus::setupDefaultPreset(void)
+{
+    setInputLevel(1.0f);
+    setOutputLevel(1.0f);
+    setThrough(1.0f);
+    setDepth(0.5f);
+    setSpeed(0.0f);
+    setPhaseShift(0.5f);
+}
 
-        left[n] -= mul_f(lerpOut(chorusLine_l, chorusOutf, chorusLenMax), chorusToMix);
-        right[n] -= mul_f(lerpOut(chorusLine_l, chorusOutf2, chorusLenMax), chorusToMix);
+void ML_Chorus::setInputLevel(float value)
+{
+    chorusInLvl = value;
+}
+
+void ML_Chorus::setThrough(float value)
+{
+    chorusThrough = value;
+}
+
+void ML_Chorus::updatePhaseShift(void)
+{
+    CSineSetPhaseShift(&sinM, chorusPhaseShift, &sinS);
+}
+
+void ML_Chorus::setPhaseShift(float value)
+{
+    chorusPhaseShift = value;
+    updatePhaseShift();
+}
+
+void ML_Chorus::setDelay(float value)
+{
+    chorusDelay = chorusLenMax * value;
+
+    if (chorusDepth + chorusDelay >= chorusLenMax)
+    {
+        chorusDelay = chorusLenMax - chorusDepth;
+    }
+}
+
+void ML_Chorus::setOutputLevel(float value)
+{
+    chorusToMix = value;
+}
 
+void ML_Chorus::setDepth(float value)
+{
+    chorusDepth = chorusLenMax * value;
 
-        chorusIn ++;
-        chorusIn = chorusIn >= chorusLenMax ? 0 : chorusIn;
+    if (chorusDepth + chorusDelay >= chorusLenMax)
+    {
+        chorusDepth = chorusLenMax - chorusDelay;
     }
 }
 
+void ML_Chorus::setSpeed(float value)
+{
+    chorusSpeed = (0.05 + 7 * value);
+
+    CSineSetFrequency(&sinM, chorusSpeed, 48000.0f);
+    updatePhaseShift();
+}
+
+/*
+ * functions of the default instance
+ */
+void Chorus_Init(int16_t *buffer, uint32_t len)
+{
+    chorusDefault.init(buffer, len);
+}
+
+void Chorus_Reset(void)
+{
+    chorusDefault.reset();
+}
+
+void Chorus_Process(float *signal_l, float *signal_r)
+{
+    chorusDefault.process(signal_l, signal_r);
+}
+
+void Chorus_Process_Buff(float *in, float *left, float *right, int buffLen)
+{
+    chorusDefault.process(in, left, right, buffLen);
+}
+
 void Chorus_SetupDefaultPreset(uint8_t unused __attribute__((unused)), float value)
 {
     if (value > 0)
@@ -243,70 +318,51 @@ void Chorus_SetupDefaultPreset(uint8_t unused __attribute__((unused)), float val
 
 void Chorus_SetInputLevel(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusInLvl = value;
+    chorusDefault.setInputLevel(value);
 
     Status_ValueChangedFloat("Chorus_SetInputLevel", value);
 }
 
 void Chorus_SetThrough(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusThrough = value;
+    chorusDefault.setThrough(value);
 
     Status_ValueChangedFloat("Chorus_SetThrough", value);
 }
 
-void Chorus_UpdatePhaseShift(void)
-{
-    CSineSetPhaseShift(&sinM, chorusPhaseShift, &sinS);
-}
-
 void Chorus_SetPhaseShift(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusPhaseShift = value;
-    Chorus_UpdatePhaseShift();
+    chorusDefault.setPhaseShift(value);
 
     Status_ValueChangedFloat("Chorus_SetPhaseShift", value);
 }
 
 void Chorus_SetDelay(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusDelay = chorusLenMax * value;
-
-    if (chorusDepth + chorusDelay >= chorusLenMax)
-    {
-        chorusDelay = chorusLenMax - chorusDepth;
-    }
+    chorusDefault.setDelay(value);
 
-    Status_ValueChangedInt("Chorus_SetDelay", chorusDelay);
+    Status_ValueChangedInt("Chorus_SetDelay", chorusDefault.getDelay());
 }
 
 void Chorus_SetOutputLevel(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusToMix = value;
+    chorusDefault.setOutputLevel(value);
 
     Status_ValueChangedFloat("Chorus_SetOutputLevel", value);
 }
 
 void Chorus_SetDepth(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusDepth = chorusLenMax * value;
+    chorusDefault.setDepth(value);
 
-    if (chorusDepth + chorusDelay >= chorusLenMax)
-    {
-        chorusDepth = chorusLenMax - chorusDelay;
-    }
-
-    Status_ValueChangedInt("Chorus_SetDepth", chorusDepth);
+    Status_ValueChangedInt("Chorus_SetDepth", chorusDefault.getDepth());
 }
 
 void Chorus_SetSpeed(uint8_t unused __attribute__((unused)), float value)
 {
-    chorusSpeed = (0.05 + 7 * value);
-
-    CSineSetFrequency(&sinM, chorusSpeed, 48000.0f);
-    Chorus_UpdatePhaseShift();
+    chorusDefault.setSpeed(value);
 
-    Status_ValueChangedFloat("Chorus_SetSpeed", chorusSpeed);
+    Status_ValueChangedFloat("Chorus_SetSpeed", chorusDefault.getSpeed());
 }
 
 #endif /* #if (!defined ARDUINO_RASPBERRY_PI_PICO) && (!defined ARDUINO_GENERIC_RP2040) */
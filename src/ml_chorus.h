@@ -47,12 +47,72 @@
 #include <Arduino.h>
 #else
 #include <stdint.h>
+#include <stddef.h>
 #endif
 
 
 #include <ml_types.h>
 
 
+struct sineL_s
+{
+    uint32_t rad;
+    uint32_t add;
+    float f;
+    float a;
+    float b;
+};
+
+/*
+ * one chorus effect, the buffer is provided by the caller
+ * the Chorus_ functions below use a default instance
+ */
+class ML_Chorus
+{
+public:
+    ML_Chorus() {};
+    ~ML_Chorus() {};
+    void init(int16_t *buffer, uint32_t len);
+    void reset(void);
+    void process(float *signal_l, float *signal_r);
+    void process(float *in, float *left, float *right, int buffLen);
+    void setupDefaultPreset(void);
+    void setInputLevel(float value);
+    void setThrough(float value);
+    void setDelay(float value);
+    void setPhaseShift(float value);
+    void setDepth(float value);
+    void setOutputLevel(float value);
+    void setSpeed(float value);
+    uint32_t getDelay(void) { return chorusDelay; };
+    float getDepth(void) { return chorusDepth; };
+    float getSpeed(void) { return chorusSpeed; };
+
+private:
+    void updatePhaseShift(void);
+    void tapPositions(float *dLast, float d, uint32_t *idx, float *frac, int buffLen);
+
+    int16_t *chorusLine_l = NULL;
+
+    float chorusToMix = 0;
+    float chorusInLvl = 1.0f;
+    float chorusDepth = 0;
+    float chorusSpeed = 2.0f / 3.0f;
+    float chorusThrough = 1.0f;
+    float chorusPhaseShift = 0.5f;
+    uint32_t chorusLenMax = 0;
+    uint32_t chorusLen = 1098;
+    uint32_t chorusDelay = 0;
+    uint32_t chorusIn = 0;
+    uint32_t chorusOut = 0;
+    float chorusMod1 = 0; /* delay of the modulated taps at the end of the last block */
+    float chorusMod2 = 0;
+
+    struct sineL_s sinM = {0, 0, 0, 0, 0};
+    struct sineL_s sinS = {0, 0, 0, 0, 0};
+};
+
+
 void Chorus_Init(int16_t *buffer, uint32_t len);
 void Chorus_Init2(int16_t *left, int16_t *right, uint32_t len);
 void Chorus_Reset(void);
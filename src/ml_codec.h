@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_codec.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains encoders and decoders to store 16 bit samples with less memory.
+ *
+ * ML_CODEC_PACK12: two samples are packed into three bytes, the 4 lowest bits are dropped
+ * ML_CODEC_ULAW: 8 bit mu-law (G.711), about 13 bit dynamic range, one byte per sample
+ *
+ * Codec_Read and Codec_Write access single samples of a buffer.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_CODEC_H_
+#define SRC_ML_CODEC_H_
+
+
+#include <stdint.h>
+
+
+#define ML_CODEC_INT16  0
+#define ML_CODEC_PACK12 1
+#define ML_CODEC_ULAW   2
+
+
+#define ML_CODEC_ULAW_BIAS  0x84
+#define ML_CODEC_ULAW_CLIP  32635
+
+
+/* bytes required to store cnt samples */
+static inline uint32_t Codec_Bytes(uint8_t format, uint32_t cnt)
+{
+    switch (format)
+    {
+    case ML_CODEC_PACK12:
+        return (cnt * 3 + 1) / 2;
+    case ML_CODEC_ULAW:
+        return cnt;
+    default:
+        return cnt * 2;
+    }
+}
+
+/* samples which fit into a buffer of the given size, always even for ML_CODEC_PACK12 */
+static inline uint32_t Codec_Samples(uint8_t format, uint32_t bytes)
+{
+    switch (format)
+    {
+    case ML_CODEC_PACK12:
+        return (bytes / 3) * 2;
+    case ML_CODEC_ULAW:
+        return bytes;
+    default:
+        return bytes / 2;
+    }
+}
+
+/* the byte which encodes a silent sample */
+static inline uint8_t Codec_Silence(uint8_t format)
+{
+    return (format == ML_CODEC_ULAW) ? 0xFF : 0;
+}
+
+static inline uint8_t Codec_ULawEncode(int16_t sample)
+{
+    int32_t pcm = sample;
+    uint8_t sign = 0;
+
+    if (pcm < 0)
+    {
+        pcm = -pcm;
+        sign = 0x80;
+    }
+    pcm = (pcm > ML_CODEC_ULAW_CLIP) ? ML_CODEC_ULAW_CLIP : pcm;
+    pcm += ML_CODEC_ULAW_BIAS;
+
+    /* position of the highest bit, pcm is in 0x84 .. 0x7FFF */
+    const uint32_t exponent = 24 - __builtin_clz(pcm);
+    const uint32_t mantissa = (pcm >> (exponent + 3)) & 0x0F;
+
+    return ~(sign | (exponent << 4) | mantissa);
+}
+
+static inline int16_t Codec_ULawDecode(uint8_t code)
+{
+    code = ~code;
+    const uint32_t exponent = (code >> 4) & 0x07;
+    const int32_t pcm = ((((code & 0x0F) << 3) + ML_CODEC_ULAW_BIAS) << exponent) - ML_CODEC_ULAW_BIAS;
+
+    return (code & 0x80) ? -pcm : pcm;
+}
+
+/*
+ * sample idx starts at byte idx * 1.5, even samples use the lower 12 bits
+ * of the two bytes, odd samples the upper 12 bits
+ */
+static inline int16_t Codec_Pack12Read(const uint8_t *buf, uint32_t idx)
+{
+    const uint8_t *p = &buf[idx + (idx >> 1)];
+    const uint32_t shift = (idx & 1) * 4;
+    const uint32_t word = p[0] | (p[1] << 8);
+
+    return (int16_t)(((word >> shift) & 0x0FFF) << 4);
+}
+
+/* rounds to 12 bit without overflow */
+static inline uint32_t Codec_Pack12Code(int16_t sample)
+{
+    const int32_t limited = (sample > 0x7FF7) ? 0x7FF7 : sample;
+    return ((limited + 8) >> 4) & 0x0FFF;
+}
+
+static inline void Codec_Pack12Write(uint8_t *buf, uint32_t idx, int16_t sample)
+{
+    uint8_t *p = &buf[idx + (idx >> 1)];
+    const uint32_t shift = (idx & 1) * 4;
+    const uint32_t code = Codec_Pack12Code(sample);
+
+    uint32_t word = p[0] | (p[1] << 8);
+    word = (word & ~(0x0FFF << shift)) | (code << shift);
+    p[0] = word;
+    p[1] = word >> 8;
+}
+
+static inline int16_t Codec_Read(uint8_t format, const uint8_t *buf, uint32_t idx)
+{
+    switch (format)
+    {
+    case ML_CODEC_PACK12:
+        return Codec_Pack12Read(buf, idx);
+    case ML_CODEC_ULAW:
+        return Codec_ULawDecode(buf[idx]);
+    default:
+        return ((const int16_t *)buf)[idx];
+    }
+}
+
+static inline void Codec_Write(uint8_t format, uint8_t *buf, uint32_t idx, int16_t sample)
+{
+    switch (format)
+    {
+    case ML_CODEC_PACK12:
+        Codec_Pack12Write(buf, idx, sample);
+        break;
+    case ML_CODEC_ULAW:
+        buf[idx] = Codec_ULawEncode(sample);
+        break;
+    default:
+        ((int16_t *)buf)[idx] = sample;
+        break;
+    }
+}
+
+
+#endif /* SRC_ML_CODEC_H_ */
@@ -48,61 +48,108 @@
 
 #include <ml_delay.h>
 #include <ml_alg.h>
+#include <ml_ring.h>
 #include <ml_status.h>
 
 
 #ifndef ARDUINO
 #include <stdio.h>
+#include <string.h>
 #endif
 
 
 /*
- * module variables
+ * default instance used by the Delay_ functions
  */
-static int16_t *delayLine_l;
-static int16_t *delayLine_r;
+static ML_Delay delayDefault;
 
-static float delayToMix = 0;
-static float delayInLvl = 1.0f;
-static float delayFeedback = 0;
-static float delayShift = 2.0f / 3.0f;
-static uint32_t delayLenMax = 0;
-static uint32_t delayLen = 11098;
-static uint32_t delayIn = 0;
-static uint32_t delayOut = 0;
-static uint32_t delayOut2 = 0;
-static uint32_t delayOut3 = 0;
 
-
-void Delay_Init(int16_t *buffer, uint32_t len)
+void ML_Delay::init(int16_t *buffer, uint32_t len)
 {
+    delayFormat = ML_CODEC_INT16;
     delayLine_l = buffer;
+    delayLine_r = NULL;
+    delayPack_l = NULL;
+    delayPack_r = NULL;
     delayLenMax = len;
+    delayIn = 0;
 
     if (delayLine_l == NULL)
     {
         printf("Not enough memory available for mono delay line!\n");
     }
 
-    Delay_Reset();
+    reset();
 }
 
-void Delay_Init2(int16_t *left, int16_t *right, uint32_t len)
+void ML_Delay::init2(int16_t *left, int16_t *right, uint32_t len)
 {
+    delayFormat = ML_CODEC_INT16;
     delayLine_l = left;
     delayLine_r = right;
+    delayPack_l = NULL;
+    delayPack_r = NULL;
     delayLenMax = len;
+    delayIn = 0;
 
     if ((delayLine_l == NULL) || (delayLine_r == NULL))
     {
         printf("Not enough memory available for stereo delay line!!\n");
     }
 
-    Delay_Reset();
+    reset();
 }
 
-void Delay_Reset(void)
+/*
+ * bytes is the size of each buffer, right can be NULL for a mono delay
+ */
+void ML_Delay::initPacked(uint8_t *left, uint8_t *right, uint32_t bytes, uint8_t format)
 {
+    delayFormat = format;
+    delayLenMax = Codec_Samples(format, bytes);
+    delayIn = 0;
+
+    /* the pointers of the other storage are cleared, reset would write to them otherwise */
+    if (format == ML_CODEC_INT16)
+    {
+        delayLine_l = (int16_t *)left;
+        delayLine_r = (int16_t *)right;
+        delayPack_l = NULL;
+        delayPack_r = NULL;
+    }
+    else
+    {
+        delayLine_l = NULL;
+        delayLine_r = NULL;
+        delayPack_l = left;
+        delayPack_r = right;
+    }
+
+    if (left == NULL)
+    {
+        printf("Not enough memory available for packed delay line!\n");
+    }
+
+    reset();
+}
+
+void ML_Delay::reset(void)
+{
+    delayLenCur = delayLen;
+
+    if (delayPack_l != NULL)
+    {
+        memset(delayPack_l, Codec_Silence(delayFormat), Codec_Bytes(delayFormat, delayLenMax));
+    }
+    if (delayPack_r != NULL)
+    {
+        memset(delayPack_r, Codec_Silence(delayFormat), Codec_Bytes(delayFormat, delayLenMax));
+    }
+    if (delayLine_l == NULL)
+    {
+        return;
+    }
+
     for (uint32_t i = 0; i < delayLenMax; i++)
     {
         delayLine_l[i] = 0;
@@ -116,8 +163,18 @@ void Delay_Reset(void)
     }
 }
 
-void Delay_Process(float *signal_l, float *signal_r __attribute__((unused)))
+void ML_Delay::process(float *signal_l, float *signal_r __attribute__((unused)))
 {
+    if (delayFormat != ML_CODEC_INT16)
+    {
+        const uint32_t out = (delayIn + (1 + delayLenMax - delayLen)) % delayLenMax;
+        const float read = readLine(0, out);
+        *signal_l += read * delayToMix / ((float)0x8000);
+        writeLine(0, delayIn, ((float)0x8000) * *signal_l * delayInLvl + read * delayFeedback);
+        delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
+        return;
+    }
+
     delayLine_l[delayIn] = (((float)0x8000) * *signal_l * delayInLvl);
 
 
@@ -141,237 +198,644 @@ void Delay_Process(float *signal_l, float *signal_r __attribute__((unused)))
     }
 }
 
-void Delay_Process_Buff(float *signal_l, int buffLen)
+/*
+ * moves the current length towards delayLen, limited by delaySlew
+ * returns false when the length is settled, d0 and d1 get the length at the start and the end of the block
+ */
+bool ML_Delay::slewLength(int buffLen, float *d0, float *d1)
+{
+    const float target = delayLen;
+
+    if ((delayLenCur == target) || (delaySlew <= 0.0f))
+    {
+        delayLenCur = target;
+        return false;
+    }
+
+    const float maxDiff = delaySlew * buffLen;
+    float diff = target - delayLenCur;
+
+    *d0 = delayLenCur;
+    if (diff > maxDiff)
+    {
+        delayLenCur += maxDiff;
+    }
+    else if (diff < -maxDiff)
+    {
+        delayLenCur -= maxDiff;
+    }
+    else
+    {
+        delayLenCur = target;
+    }
+    *d1 = delayLenCur;
+
+    return true;
+}
+
+/*
+ * read positions of one tap while the length is changing
+ * the delay is kept away from the write position and the end of the line for the interpolation
+ */
+void ML_Delay::tapPositions(uint32_t *idx, float *frac, float d0, float d1, int buffLen)
+{
+    const float dMax = (delayLenMax > 4) ? delayLenMax - 4 : 0;
+
+    d0 = d0 < 2.0f ? 2.0f : (d0 > dMax ? dMax : d0);
+    d1 = d1 < 2.0f ? 2.0f : (d1 > dMax ? dMax : d1);
+
+    Ring_Positions(delayIn, delayLenMax, d0, (d1 - d0) / buffLen, idx, frac, buffLen);
+}
+
+/*
+ * returns true when the taps are read with interpolation
+ * this is used while the length changes and always with a compressed format
+ */
+bool ML_Delay::interpolated(int buffLen, float *d0, float *d1)
+{
+    if (slewLength(buffLen, d0, d1))
+    {
+        return true;
+    }
+    *d0 = delayLenCur;
+    *d1 = delayLenCur;
+    return delayFormat != ML_CODEC_INT16;
+}
+
+inline float ML_Delay::readTap(uint8_t ch, uint32_t idx, float frac)
+{
+    if (delayFormat == ML_CODEC_INT16)
+    {
+        const int16_t *line = (ch == 0) ? delayLine_l : delayLine_r;
+        return delayHermite ? Ring_ReadHermite(line, delayLenMax, idx, frac) : Ring_ReadLinear(line, delayLenMax, idx, frac);
+    }
+
+    const float x0 = readLine(ch, idx);
+
+    /* the length is settled, this saves decoding the neighbours */
+    if (frac == 0.0f)
+    {
+        return x0;
+    }
+
+    const float x1 = readLine(ch, Ring_Wrap(idx + 1, delayLenMax));
+
+    if (delayHermite)
+    {
+        const float xm1 = readLine(ch, (idx == 0) ? (delayLenMax - 1) : (idx - 1));
+        const float x2 = readLine(ch, Ring_Wrap(idx + 2, delayLenMax));
+        return Ring_Hermite(xm1, x0, x1, x2, frac);
+    }
+    return Ring_Linear(x0, x1, frac);
+}
+
+inline int16_t ML_Delay::readLine(uint8_t ch, uint32_t idx)
 {
-    for (int n = 0; n < buffLen; n++)
+    if (delayFormat == ML_CODEC_INT16)
     {
-        delayLine_l[delayIn] = (((float)0x4000) * signal_l[n] * delayInLvl);
+        return ((ch == 0) ? delayLine_l : delayLine_r)[idx];
+    }
+    return Codec_Read(delayFormat, (ch == 0) ? delayPack_l : delayPack_r, idx);
+}
 
-        delayOut = delayIn + (1 + delayLenMax - delayLen);
+/* the value is saturated, the feedback path of a compressed line would wrap around otherwise */
+inline void ML_Delay::writeLine(uint8_t ch, uint32_t idx, int32_t value)
+{
+    value = (value > 32767) ? 32767 : ((value < -32768) ? -32768 : value);
 
-        if (delayOut >= delayLenMax)
+    if (delayFormat == ML_CODEC_INT16)
+    {
+        ((ch == 0) ? delayLine_l : delayLine_r)[idx] = value;
+    }
+    else
+    {
+        Codec_Write(delayFormat, (ch == 0) ? delayPack_l : delayPack_r, idx, value);
+    }
+}
+
+/*
+ * the block functions split each block into runs in which neither the write
+ * nor any read position wraps, see ml_ring.h
+ * the tap offsets are calculated once per block
+ *
+ * while the length is changing or with a compressed format the taps are read with
+ * interpolation, a tap delays by its length - 1 like the offsets used in the runs
+ * the lines are written once per sample, the taps are at least two samples behind
+ */
+void ML_Delay::process(float *signal_l, int buffLen)
+{
+    float d0, d1;
+
+    if (interpolated(buffLen, &d0, &d1))
+    {
+        uint32_t idx[buffLen];
+        float frac[buffLen];
+        tapPositions(idx, frac, d0 - 1, d1 - 1, buffLen);
+
+        for (int n = 0; n < buffLen; n++)
         {
-            delayOut -= delayLenMax;
+            const float out = readTap(0, idx[n], frac[n]);
+            writeLine(0, delayIn, ((float)0x4000) * signal_l[n] * delayInLvl + out * delayFeedback);
+            signal_l[n] += out * delayToMix / ((float)0x4000);
+            delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
         }
+        return;
+    }
 
-        signal_l[n] += ((float)delayLine_l[delayOut]) * delayToMix / ((float)0x4000);
+    const uint32_t off = (1 + delayLenMax - delayLen) % delayLenMax;
+
+    for (int n = 0; n < buffLen;)
+    {
+        const uint32_t out = Ring_Wrap(delayIn + off, delayLenMax);
 
-        delayLine_l[delayIn] += (((float)delayLine_l[delayOut]) * delayFeedback);
+        uint32_t run = Ring_Run(delayIn, delayLenMax, buffLen - n);
+        run = Ring_Run(out, delayLenMax, run);
 
-        delayIn ++;
+        int16_t *lineIn = &delayLine_l[delayIn];
+        int16_t *lineOut = &delayLine_l[out];
+        float *sig = &signal_l[n];
 
-        if (delayIn >= delayLenMax)
+        for (uint32_t k = 0; k < run; k++)
         {
-            delayIn = 0;
+            lineIn[k] = (((float)0x4000) * sig[k] * delayInLvl);
+            sig[k] += ((float)lineOut[k]) * delayToMix / ((float)0x4000);
+            lineIn[k] += (((float)lineOut[k]) * delayFeedback);
         }
+
+        n += run;
+        delayIn = Ring_Wrap(delayIn + run, delayLenMax);
     }
 }
 
-void Delay_Process_Buff(int16_t *signal_l, int buffLen)
+void ML_Delay::process(int16_t *signal_l, int buffLen)
 {
     uint16_t delayInLvl_u = delayInLvl * 32768;
     uint16_t delayToMix_u = delayToMix * 32768;
     uint16_t delayFeedback_u = delayFeedback * 32768;
 
-    for (int n = 0; n < buffLen; n++)
-    {
-        int32_t sigIn = (int32_t)signal_l[n] * (uint32_t)delayInLvl_u;
-        sigIn >>= 15;
-        delayLine_l[delayIn] = sigIn;
+    float d0, d1;
 
-        delayOut = delayIn + (1 + delayLenMax - delayLen);
+    if (interpolated(buffLen, &d0, &d1))
+    {
+        uint32_t idx[buffLen];
+        float frac[buffLen];
+        tapPositions(idx, frac, d0 - 1, d1 - 1, buffLen);
 
-        if (delayOut >= delayLenMax)
+        for (int n = 0; n < buffLen; n++)
         {
-            delayOut -= delayLenMax;
+            int32_t sigIn = (int32_t)signal_l[n] * (uint32_t)delayInLvl_u;
+            sigIn >>= 15;
+
+            const int32_t out = readTap(0, idx[n], frac[n]);
+
+            int32_t sigMix = out * (int32_t)delayToMix_u;
+            sigMix >>= 15;
+            signal_l[n] += sigMix;
+
+            int32_t sigFb = out * (int32_t)delayFeedback_u;
+            sigFb >>= 15;
+            writeLine(0, delayIn, sigIn + sigFb);
+
+            delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
         }
+        return;
+    }
+
+    const uint32_t off = (1 + delayLenMax - delayLen) % delayLenMax;
 
-        int32_t sigMix = (int32_t)delayLine_l[delayOut] * (uint32_t)delayToMix_u;
-        sigMix >>= 15;
-        signal_l[n] += sigMix;
+    for (int n = 0; n < buffLen;)
+    {
+        const uint32_t out = Ring_Wrap(delayIn + off, delayLenMax);
 
-        int32_t sigFb = (int32_t)delayLine_l[delayOut] * (uint32_t)delayFeedback_u;
-        sigFb >>= 15;
-        delayLine_l[delayIn] += sigFb;
+        uint32_t run = Ring_Run(delayIn, delayLenMax, buffLen - n);
+        run = Ring_Run(out, delayLenMax, run);
 
-        delayIn ++;
+        int16_t *lineIn = &delayLine_l[delayIn];
+        int16_t *lineOut = &delayLine_l[out];
+        int16_t *sig = &signal_l[n];
 
-        if (delayIn >= delayLenMax)
+        for (uint32_t k = 0; k < run; k++)
         {
-            delayIn = 0;
+            int32_t sigIn = (int32_t)sig[k] * (uint32_t)delayInLvl_u;
+            sigIn >>= 15;
+            lineIn[k] = sigIn;
+
+            int32_t sigMix = (int32_t)lineOut[k] * (uint32_t)delayToMix_u;
+            sigMix >>= 15;
+            sig[k] += sigMix;
+
+            int32_t sigFb = (int32_t)lineOut[k] * (uint32_t)delayFeedback_u;
+            sigFb >>= 15;
+            lineIn[k] += sigFb;
         }
+
+        n += run;
+        delayIn = Ring_Wrap(delayIn + run, delayLenMax);
     }
 }
 
 
-void Delay_Process_Buff(float *in, float *left, float *right, int buffLen)
+void ML_Delay::process(float *in, float *left, float *right, int buffLen)
 {
-    for (int n = 0; n < buffLen; n++)
-    {
-        delayLine_l[delayIn] = (((float)0x4000) * in[n] * delayInLvl);
+    float d0, d1;
 
-        delayOut = delayIn + (1 + delayLenMax - delayLen);
-        delayOut2 = delayIn + (1 + delayLenMax - (delayLen - 1000));
-        delayOut3 = delayIn + (1 + delayLenMax - (delayLen * delayShift));
+    if (interpolated(buffLen, &d0, &d1))
+    {
+        uint32_t idx1[buffLen], idx2[buffLen], idx3[buffLen];
+        float frac1[buffLen], frac2[buffLen], frac3[buffLen];
+        tapPositions(idx1, frac1, d0 - 1, d1 - 1, buffLen);
+        tapPositions(idx2, frac2, d0 - 1001, d1 - 1001, buffLen);
+        tapPositions(idx3, frac3, d0 * delayShift - 1, d1 * delayShift - 1, buffLen);
 
-        if (delayOut >= delayLenMax)
+        for (int n = 0; n < buffLen; n++)
         {
-            delayOut -= delayLenMax;
-        }
+            const float out1 = readTap(0, idx1[n], frac1[n]);
+            const float out2 = readTap(0, idx2[n], frac2[n]);
+            const float out3 = readTap(0, idx3[n], frac3[n]);
 
-        if (delayOut2 >= delayLenMax)
-        {
-            delayOut2 -= delayLenMax;
-        }
+            left[n] += out1 * delayToMix / ((float)0x4000);
+            right[n] += out2 * delayToMix / ((float)0x4000);
+            left[n] += out3 * delayToMix / ((float)0x4000);
 
-        if (delayOut3 >= delayLenMax)
-        {
-            delayOut3 -= delayLenMax;
+            writeLine(0, idx2[n], readLine(0, idx2[n]) + out1 * delayFeedback);
+            writeLine(0, delayIn, ((float)0x4000) * in[n] * delayInLvl + out3 * delayFeedback);
+
+            delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
         }
+        return;
+    }
+
+    const uint32_t off = (1 + delayLenMax - delayLen) % delayLenMax;
+    const uint32_t off2 = (1 + delayLenMax - (delayLen - 1000)) % delayLenMax;
+    const float off3 = 1 + delayLenMax - (delayLen * delayShift);
 
-        left[n] += mul_f(delayLine_l[delayOut], delayToMix);
-        right[n] += mul_f(delayLine_l[delayOut2], delayToMix);
-        left[n] += mul_f(delayLine_l[delayOut3], delayToMix);
+    for (int n = 0; n < buffLen;)
+    {
+        const uint32_t out = Ring_Wrap(delayIn + off, delayLenMax);
+        const uint32_t out2 = Ring_Wrap(delayIn + off2, delayLenMax);
+        const uint32_t out3 = (uint32_t)(delayIn + off3) % delayLenMax;
 
-        delayLine_l[delayOut2] += (((float)delayLine_l[delayOut]) * delayFeedback);
-        delayLine_l[delayIn] += (((float)delayLine_l[delayOut3]) * delayFeedback);
+        uint32_t run = Ring_Run(delayIn, delayLenMax, buffLen - n);
+        run = Ring_Run(out, delayLenMax, run);
+        run = Ring_Run(out2, delayLenMax, run);
+        run = Ring_Run(out3, delayLenMax, run);
 
-        delayIn ++;
+        int16_t *lineIn = &delayLine_l[delayIn];
+        int16_t *line1 = &delayLine_l[out];
+        int16_t *line2 = &delayLine_l[out2];
+        int16_t *line3 = &delayLine_l[out3];
 
-        if (delayIn >= delayLenMax)
+        for (uint32_t k = 0; k < run; k++)
         {
-            delayIn = 0;
+            lineIn[k] = (((float)0x4000) * in[n + k] * delayInLvl);
+
+            left[n + k] += mul_f(line1[k], delayToMix);
+            right[n + k] += mul_f(line2[k], delayToMix);
+            left[n + k] += mul_f(line3[k], delayToMix);
+
+            line2[k] += (((float)line1[k]) * delayFeedback);
+            lineIn[k] += (((float)line3[k]) * delayFeedback);
         }
+
+        n += run;
+        delayIn = Ring_Wrap(delayIn + run, delayLenMax);
     }
 }
 
 /*
  * this implementation is not complete
  */
-void Delay_Process_Buff(float *in_l, float *in_r, float *left, float *right, int buffLen)
+void ML_Delay::process(float *in_l, float *in_r, float *left, float *right, int buffLen)
 {
-    for (int n = 0; n < buffLen; n++)
-    {
-        delayLine_l[delayIn] = (((float)0x4000) * in_l[n] * delayInLvl);
-        delayLine_r[delayIn] = (((float)0x4000) * in_r[n] * delayInLvl);
+    float d0, d1;
 
-        delayOut = delayIn + (1 + delayLenMax - delayLen);
-        delayOut2 = delayIn + (1 + delayLenMax - (delayLen - 1000));
-        delayOut3 = delayIn + (1 + delayLenMax - (delayLen * delayShift));
+    if (interpolated(buffLen, &d0, &d1))
+    {
+        uint32_t idx1[buffLen], idx2[buffLen], idx3[buffLen];
+        float frac1[buffLen], frac2[buffLen], frac3[buffLen];
+        tapPositions(idx1, frac1, d0 - 1, d1 - 1, buffLen);
+        tapPositions(idx2, frac2, d0 - 1001, d1 - 1001, buffLen);
+        tapPositions(idx3, frac3, d0 * delayShift - 1, d1 * delayShift - 1, buffLen);
 
-        if (delayOut >= delayLenMax)
+        for (int n = 0; n < buffLen; n++)
         {
-            delayOut -= delayLenMax;
+            const float out1_l = readTap(0, idx1[n], frac1[n]);
+            const float out3_l = readTap(0, idx3[n], frac3[n]);
+            const float out1_r = readTap(1, idx1[n], frac1[n]);
+            const float out2_r = readTap(1, idx2[n], frac2[n]);
+            const float out3_r = readTap(1, idx3[n], frac3[n]);
+
+            left[n] += out1_l * delayToMix / ((float)0x4000);
+            right[n] += out2_r * delayToMix / ((float)0x4000);
+            left[n] += out3_l * delayToMix / ((float)0x4000);
+
+            writeLine(0, idx2[n], readLine(0, idx2[n]) + out1_l * delayFeedback);
+            writeLine(0, delayIn, ((float)0x4000) * in_l[n] * delayInLvl + out3_l * delayFeedback);
+
+            writeLine(1, idx2[n], readLine(1, idx2[n]) + out1_r * delayFeedback);
+            writeLine(1, delayIn, ((float)0x4000) * in_r[n] * delayInLvl + out3_r * delayFeedback);
+
+            delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
         }
+        return;
+    }
 
-        if (delayOut2 >= delayLenMax)
+    const uint32_t off = (1 + delayLenMax - delayLen) % delayLenMax;
+    const uint32_t off2 = (1 + delayLenMax - (delayLen - 1000)) % delayLenMax;
+    const float off3 = 1 + delayLenMax - (delayLen * delayShift);
+
+    for (int n = 0; n < buffLen;)
+    {
+        const uint32_t out = Ring_Wrap(delayIn + off, delayLenMax);
+        const uint32_t out2 = Ring_Wrap(delayIn + off2, delayLenMax);
+        const uint32_t out3 = (uint32_t)(delayIn + off3) % delayLenMax;
+
+        uint32_t run = Ring_Run(delayIn, delayLenMax, buffLen - n);
+        run = Ring_Run(out, delayLenMax, run);
+        run = Ring_Run(out2, delayLenMax, run);
+        run = Ring_Run(out3, delayLenMax, run);
+
+        int16_t *lineIn_l = &delayLine_l[delayIn];
+        int16_t *line1_l = &delayLine_l[out];
+        int16_t *line2_l = &delayLine_l[out2];
+        int16_t *line3_l = &delayLine_l[out3];
+
+        int16_t *lineIn_r = &delayLine_r[delayIn];
+        int16_t *line1_r = &delayLine_r[out];
+        int16_t *line2_r = &delayLine_r[out2];
+        int16_t *line3_r = &delayLine_r[out3];
+
+        for (uint32_t k = 0; k < run; k++)
         {
-            delayOut2 -= delayLenMax;
+            lineIn_l[k] = (((float)0x4000) * in_l[n + k] * delayInLvl);
+            lineIn_r[k] = (((float)0x4000) * in_r[n + k] * delayInLvl);
+
+            left[n + k] += mul_f(line1_l[k], delayToMix);
+            right[n + k] += mul_f(line2_r[k], delayToMix);
+            left[n + k] += mul_f(line3_l[k], delayToMix);
+
+            line2_l[k] += (((float)line1_l[k]) * delayFeedback);
+            lineIn_l[k] += (((float)line3_l[k]) * delayFeedback);
+
+            line2_r[k] += (((float)line1_r[k]) * delayFeedback);
+            lineIn_r[k] += (((float)line3_r[k]) * delayFeedback);
         }
 
-        if (delayOut3 >= delayLenMax)
+        n += run;
+        delayIn = Ring_Wrap(delayIn + run, delayLenMax);
+    }
+}
+
+void ML_Delay::process(int16_t *in, int16_t *left, int16_t *right, int buffLen)
+{
+    float d0, d1;
+
+    if (interpolated(buffLen, &d0, &d1))
+    {
+        uint32_t idx1[buffLen], idx2[buffLen], idx3[buffLen];
+        float frac1[buffLen], frac2[buffLen], frac3[buffLen];
+        tapPositions(idx1, frac1, d0 - 1, d1 - 1, buffLen);
+        tapPositions(idx2, frac2, d0 - 1001, d1 - 1001, buffLen);
+        tapPositions(idx3, frac3, d0 * (2.0f / 3.0f) - 1, d1 * (2.0f / 3.0f) - 1, buffLen);
+
+        for (int n = 0; n < buffLen; n++)
         {
-            delayOut3 -= delayLenMax;
+            const float out1 = readTap(0, idx1[n], frac1[n]);
+            const float out2 = readTap(0, idx2[n], frac2[n]);
+            const float out3 = readTap(0, idx3[n], frac3[n]);
+
+            left[n] += (int16_t)(out1 * delayToMix);
+            right[n] += (int16_t)(out2 * delayToMix);
+            left[n] += (int16_t)(out3 * delayToMix);
+
+            writeLine(0, idx2[n], readLine(0, idx2[n]) + out1 * delayFeedback);
+            writeLine(0, delayIn, in[n] * delayInLvl + out3 * delayFeedback);
+
+            delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
         }
+        return;
+    }
 
-        left[n] += mul_f(delayLine_l[delayOut], delayToMix);
-        right[n] += mul_f(delayLine_r[delayOut2], delayToMix);
-        left[n] += mul_f(delayLine_l[delayOut3], delayToMix);
+    const uint32_t off = (1 + delayLenMax - delayLen) % delayLenMax;
+    const uint32_t off2 = (1 + delayLenMax - (delayLen - 1000)) % delayLenMax;
+    const uint32_t off3 = (1 + delayLenMax - (delayLen / 3 * 2)) % delayLenMax;
 
-        delayLine_l[delayOut2] += (((float)delayLine_l[delayOut]) * delayFeedback);
-        delayLine_l[delayIn] += (((float)delayLine_l[delayOut3]) * delayFeedback);
+    for (int n = 0; n < buffLen;)
+    {
+        const uint32_t out = Ring_Wrap(delayIn + off, delayLenMax);
+        const uint32_t out2 = Ring_Wrap(delayIn + off2, delayLenMax);
+        const uint32_t out3 = Ring_Wrap(delayIn + off3, delayLenMax);
 
-        delayLine_r[delayOut2] += (((float)delayLine_r[delayOut]) * delayFeedback);
-        delayLine_r[delayIn] += (((float)delayLine_r[delayOut3]) * delayFeedback);
+        uint32_t run = Ring_Run(delayIn, delayLenMax, buffLen - n);
+        run = Ring_Run(out, delayLenMax, run);
+        run = Ring_Run(out2, delayLenMax, run);
+        run = Ring_Run(out3, delayLenMax, run);
 
-        delayIn ++;
+        int16_t *lineIn = &delayLine_l[delayIn];
+        int16_t *line1 = &delayLine_l[out];
+        int16_t *line2 = &delayLine_l[out2];
+        int16_t *line3 = &delayLine_l[out3];
 
-        if (delayIn >= delayLenMax)
+        for (uint32_t k = 0; k < run; k++)
         {
-            delayIn = 0;
+            lineIn[k] = mul(in[n + k], delayInLvl);
+
+            left[n + k] += mul(line1[k], delayToMix);
+            right[n + k] += mul(line2[k], delayToMix);
+            left[n + k] += mul(line3[k], delayToMix);
+
+            line2[k] += mul(line1[k], delayFeedback);
+            lineIn[k] += mul(line3[k], delayFeedback);
         }
+
+        n += run;
+        delayIn = Ring_Wrap(delayIn + run, delayLenMax);
     }
 }
 
-void Delay_Process_Buff(int16_t *in, int16_t *left, int16_t *right, int buffLen)
+void ML_Delay::process2(float *signal_l, float *signal_r, int buffLen)
 {
-    for (int n = 0; n < buffLen; n++)
-    {
-        delayLine_l[delayIn] = mul(in[n], delayInLvl);
+    float d0, d1;
 
-        delayOut = delayIn + (1 + delayLenMax - delayLen);
-        delayOut2 = delayIn + (1 + delayLenMax - (delayLen - 1000));
-        delayOut3 = delayIn + (1 + delayLenMax - (delayLen / 3 * 2));
+    if (interpolated(buffLen, &d0, &d1))
+    {
+        uint32_t idx[buffLen];
+        float frac[buffLen];
+        tapPositions(idx, frac, d0 - 1, d1 - 1, buffLen);
 
-        if (delayOut >= delayLenMax)
+        for (int n = 0; n < buffLen; n++)
         {
-            delayOut -= delayLenMax;
-        }
+            const float out_l = readTap(0, idx[n], frac[n]);
+            const float out_r = readTap(1, idx[n], frac[n]);
 
-        if (delayOut2 >= delayLenMax)
-        {
-            delayOut2 -= delayLenMax;
-        }
+            writeLine(0, delayIn, ((float)0x8000) * signal_l[n] * delayInLvl + out_l * delayFeedback);
+            writeLine(1, delayIn, ((float)0x8000) * signal_r[n] * delayInLvl + out_r * delayFeedback);
 
-        if (delayOut3 >= delayLenMax)
-        {
-            delayOut3 -= delayLenMax;
+            signal_l[n] += out_l * delayToMix / ((float)0x8000);
+            signal_r[n] += out_r * delayToMix / ((float)0x8000);
+
+            delayIn = Ring_Wrap(delayIn + 1, delayLenMax);
         }
+        return;
+    }
 
-        left[n] += mul(delayLine_l[delayOut], delayToMix);
-        right[n] += mul(delayLine_l[delayOut2], delayToMix);
-        left[n] += mul(delayLine_l[delayOut3], delayToMix);
+    const uint32_t off = (1 + delayLenMax - delayLen) % delayLenMax;
 
-        delayLine_l[delayOut2] += mul(delayLine_l[delayOut], delayFeedback);
-        delayLine_l[delayIn] += mul(delayLine_l[delayOut3], delayFeedback);
+    for (int n = 0; n < buffLen;)
+    {
+        const uint32_t out = Ring_Wrap(delayIn + off, delayLenMax);
+
+        uint32_t run = Ring_Run(delayIn, delayLenMax, buffLen - n);
+        run = Ring_Run(out, delayLenMax, run);
 
-        delayIn ++;
+        int16_t *lineIn_l = &delayLine_l[delayIn];
+        int16_t *lineIn_r = &delayLine_r[delayIn];
+        int16_t *lineOut_l = &delayLine_l[out];
+        int16_t *lineOut_r = &delayLine_r[out];
 
-        if (delayIn >= delayLenMax)
+        for (uint32_t k = 0; k < run; k++)
         {
-            delayIn = 0;
+            lineIn_l[k] = (((float)0x8000) * signal_l[n + k] * delayInLvl);
+            lineIn_r[k] = (((float)0x8000) * signal_r[n + k] * delayInLvl);
+
+            signal_l[n + k] += ((float)lineOut_l[k]) * delayToMix / ((float)0x8000);
+            signal_r[n + k] += ((float)lineOut_r[k]) * delayToMix / ((float)0x8000);
+
+            lineIn_l[k] += (((float)lineOut_l[k]) * delayFeedback);
+            lineIn_r[k] += (((float)lineOut_r[k]) * delayFeedback);
         }
+
+        n += run;
+        delayIn = Ring_Wrap(delayIn + run, delayLenMax);
     }
 }
 
-void Delay_Process_Buff2(float *signal_l, float *signal_r, int buffLen)
+void ML_Delay::setInputLevel(float value)
+{
+    delayInLvl = value;
+}
+
+void ML_Delay::setFeedback(float value)
+{
+    delayFeedback = value;
+}
+
+void ML_Delay::setOutputLevel(float value)
+{
+    delayToMix = value;
+}
+
+void ML_Delay::setLength(float value)
+{
+    delayLen = (uint32_t)(((float)delayLenMax - 1.0f) * value);
+}
+
+void ML_Delay::setLength(uint32_t value)
 {
-    for (int n = 0; n < buffLen; n++)
+    if (value != delayLen)
     {
-        delayLine_l[delayIn] = (((float)0x8000) * signal_l[n] * delayInLvl);
-        delayLine_r[delayIn] = (((float)0x8000) * signal_r[n] * delayInLvl);
+        delayLen = value < delayLenMax ? value : delayLenMax;
+    }
+}
+
+void ML_Delay::setShift(float value)
+{
+    delayShift = value;
+}
 
-        delayOut = delayIn + (1 + delayLenMax - delayLen);
+/*
+ * limits how fast the length follows setLength, in samples per sample
+ * 0 changes the length immediately, values up to 1 give tape like pitch sweeps
+ */
+void ML_Delay::setSlew(float value)
+{
+    delaySlew = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
 
-        if (delayOut >= delayLenMax)
-        {
-            delayOut -= delayLenMax;
-        }
+void ML_Delay::setInterpolation(bool hermite)
+{
+    delayHermite = hermite;
+}
 
-        signal_l[n] += ((float)delayLine_l[delayOut]) * delayToMix / ((float)0x8000);
-        signal_r[n] += ((float)delayLine_r[delayOut]) * delayToMix / ((float)0x8000);
+/* memory used for one second of delay with the current format, both lines included */
+uint32_t ML_Delay::getBytesPerSecond(float sample_rate)
+{
+    const uint32_t lines = ((delayLine_r != NULL) || (delayPack_r != NULL)) ? 2 : 1;
+    return lines * Codec_Bytes(delayFormat, (uint32_t)sample_rate);
+}
 
-        delayLine_l[delayIn] += (((float)delayLine_l[delayOut]) * delayFeedback);
-        delayLine_r[delayIn] += (((float)delayLine_r[delayOut]) * delayFeedback);
+/*
+ * functions of the default instance
+ */
+void Delay_Init(int16_t *buffer, uint32_t len)
+{
+    delayDefault.init(buffer, len);
+}
 
-        delayIn ++;
+void Delay_Init2(int16_t *left, int16_t *right, uint32_t len)
+{
+    delayDefault.init2(left, right, len);
+}
 
-        if (delayIn >= delayLenMax)
-        {
-            delayIn = 0;
-        }
-    }
+void Delay_InitPacked(uint8_t *left, uint8_t *right, uint32_t bytes, uint8_t format)
+{
+    delayDefault.initPacked(left, right, bytes, format);
+}
+
+uint32_t Delay_GetBytesPerSecond(float sample_rate)
+{
+    return delayDefault.getBytesPerSecond(sample_rate);
+}
+
+void Delay_Reset(void)
+{
+    delayDefault.reset();
+}
+
+void Delay_Process(float *signal_l, float *signal_r)
+{
+    delayDefault.process(signal_l, signal_r);
+}
+
+void Delay_Process_Buff(float *signal_l, int buffLen)
+{
+    delayDefault.process(signal_l, buffLen);
+}
+
+void Delay_Process_Buff(int16_t *signal_l, int buffLen)
+{
+    delayDefault.process(signal_l, buffLen);
+}
+
+void Delay_Process_Buff(float *in, float *left, float *right, int buffLen)
+{
+    delayDefault.process(in, left, right, buffLen);
+}
+
+void Delay_Process_Buff(float *in_l, float *in_r, float *left, float *right, int buffLen)
+{
+    delayDefault.process(in_l, in_r, left, right, buffLen);
+}
+
+void Delay_Process_Buff(int16_t *in, int16_t *left, int16_t *right, int buffLen)
+{
+    delayDefault.process(in, left, right, buffLen);
+}
+
+void Delay_Process_Buff2(float *signal_l, float *signal_r, int buffLen)
+{
+    delayDefault.process2(signal_l, signal_r, buffLen);
 }
 
 void Delay_SetInputLevel(uint8_t unused __attribute__((unused)), float value)
 {
-    delayInLvl = value;
+    delayDefault.setInputLevel(value);
     Status_ValueChangedFloat("Delay_SetInputLevel", value);
 }
 
 void Delay_SetFeedback(uint8_t unused __attribute__((unused)), float value)
 {
-    delayFeedback = value;
+    delayDefault.setFeedback(value);
     Status_ValueChangedFloat("Delay_SetFeedback", value);
 }
 
@@ -379,13 +843,13 @@ void Delay_SetFeedback(uint8_t unused __attribute__((unused)), uint8_t value)
 {
     float value_f = value;
     value_f /= 127.0;
-    delayFeedback = value_f;
+    delayDefault.setFeedback(value_f);
     Status_ValueChangedFloat("Delay_SetFeedback", value);
 }
 
 void Delay_SetOutputLevel(uint8_t unused __attribute__((unused)), float value)
 {
-    delayToMix = value;
+    delayDefault.setOutputLevel(value);
     Status_ValueChangedFloat("Delay_SetOutputLevel", value);
 }
 
@@ -393,27 +857,36 @@ void Delay_SetOutputLevel(uint8_t unused __attribute__((unused)), uint8_t value)
 {
     float value_f = value;
     value_f /= 127.0;
-    delayToMix = value_f;
+    delayDefault.setOutputLevel(value_f);
     Status_ValueChangedFloat("Delay_SetOutputLevel", value);
 }
 
 void Delay_SetLength(uint8_t unused __attribute__((unused)), float value)
 {
-    delayLen = (uint32_t)(((float)delayLenMax - 1.0f) * value);
+    delayDefault.setLength(value);
     Status_ValueChangedFloat("Delay_SetLength", value);
 }
 
 void Delay_SetLength(uint8_t unused __attribute__((unused)), uint32_t value)
 {
-    if (value != delayLen)
-    {
-        delayLen = value < delayLenMax ? value : delayLenMax;
-    }
+    delayDefault.setLength(value);
     Status_ValueChangedInt("Delay_SetLength", value);
 }
 
 void Delay_SetShift(uint8_t unused __attribute__((unused)), float value)
 {
-    delayShift = value;
+    delayDefault.setShift(value);
     Status_ValueChangedFloat("Delay_SetShift", value);
 }
+
+void Delay_SetSlew(uint8_t unused __attribute__((unused)), float value)
+{
+    delayDefault.setSlew(value);
+    Status_ValueChangedFloat("Delay_SetSlew", value);
+}
+
+void Delay_SetHermite(uint8_t unused __attribute__((unused)), float value)
+{
+    delayDefault.setInterpolation(value > 0);
+    Status_ValueChangedInt("Delay_SetHermite", value > 0);
+}
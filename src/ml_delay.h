@@ -45,11 +45,77 @@
 #include <Arduino.h>
 #else
 #include <stdint.h>
+#include <stddef.h>
 #endif
 
+#include <ml_codec.h>
+
+
+/*
+ * one delay effect, the buffers are provided by the caller
+ * the Delay_ functions below use a default instance
+ *
+ * initPacked stores the lines with a format from ml_codec.h, this gives
+ * longer delays with the same memory at lower fidelity
+ */
+class ML_Delay
+{
+public:
+    ML_Delay() {};
+    ~ML_Delay() {};
+    void init(int16_t *buffer, uint32_t len);
+    void init2(int16_t *left, int16_t *right, uint32_t len);
+    void initPacked(uint8_t *left, uint8_t *right, uint32_t bytes, uint8_t format);
+    void reset(void);
+    void process(float *signal_l, float *signal_r);
+    void process(float *signal_l, int buffLen);
+    void process(int16_t *signal_l, int buffLen);
+    void process(float *in, float *left, float *right, int buffLen);
+    void process(float *in_l, float *in_r, float *left, float *right, int buffLen);
+    void process(int16_t *in, int16_t *left, int16_t *right, int buffLen);
+    void process2(float *signal_l, float *signal_r, int buffLen);
+    void setInputLevel(float value);
+    void setFeedback(float value);
+    void setOutputLevel(float value);
+    void setLength(float value);
+    void setLength(uint32_t value);
+    void setShift(float value);
+    void setSlew(float value);
+    void setInterpolation(bool hermite);
+    uint32_t getBytesPerSecond(float sample_rate);
+
+private:
+    bool slewLength(int buffLen, float *d0, float *d1);
+    void tapPositions(uint32_t *idx, float *frac, float d0, float d1, int buffLen);
+    bool interpolated(int buffLen, float *d0, float *d1);
+    float readTap(uint8_t ch, uint32_t idx, float frac);
+    int16_t readLine(uint8_t ch, uint32_t idx);
+    void writeLine(uint8_t ch, uint32_t idx, int32_t value);
+
+    int16_t *delayLine_l = NULL;
+    int16_t *delayLine_r = NULL;
+    uint8_t *delayPack_l = NULL; /* used instead of delayLine_l/r with a compressed format */
+    uint8_t *delayPack_r = NULL;
+    uint8_t delayFormat = ML_CODEC_INT16;
+
+    float delayToMix = 0;
+    float delayInLvl = 1.0f;
+    float delayFeedback = 0;
+    float delayShift = 2.0f / 3.0f;
+    uint32_t delayLenMax = 0;
+    uint32_t delayLen = 11098;
+    uint32_t delayIn = 0;
+    uint32_t delayOut = 0;
+    float delayLenCur = 11098; /* follows delayLen, limited by delaySlew */
+    float delaySlew = 0; /* max. change of the length per sample, 0: change immediately */
+    bool delayHermite = false;
+};
+
 
 void Delay_Init(int16_t *buffer, uint32_t len);
 void Delay_Init2(int16_t *left, int16_t *right, uint32_t len);
+void Delay_InitPacked(uint8_t *left, uint8_t *right, uint32_t bytes, uint8_t format);
+uint32_t Delay_GetBytesPerSecond(float sample_rate);
 void Delay_Reset(void);
 void Delay_Process_Buff(float *signal_l, int buffLen);
 void Delay_Process_Buff(int16_t *signal_l, int buffLen);
@@ -66,6 +132,8 @@ void Delay_SetOutputLevel(uint8_t unused __attribute__((unused)), uint8_t value)
 void Delay_SetLength(uint8_t unused __attribute__((unused)), float value);
 void Delay_SetLength(uint8_t unused __attribute__((unused)), uint32_t value);
 void Delay_SetShift(uint8_t unused __attribute__((unused)), float value);
+void Delay_SetSlew(uint8_t unused __attribute__((unused)), float value);
+void Delay_SetHermite(uint8_t unused __attribute__((unused)), float value);
 
 
 void DelayQ_Init(int16_t *buffer, uint32_t len);
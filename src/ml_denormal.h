@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_denormal.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains the helpers to avoid denormal (subnormal) floats.
+ *
+ * Recursive loops (reverb, filters, envelopes) decay towards zero when the input stops.
+ * Below 1.2e-38 the values become denormal and many FPUs (x86 without FTZ, some Cortex-M)
+ * need a multiple of the normal time per operation, the CPU load rises exactly when the
+ * synth goes quiet.
+ *
+ * The library uses two strategies:
+ * - delay line loops get a tiny constant (ML_DENORMAL_DC) added to their input
+ * - filter and envelope states are flushed to zero once per block when they are very small
+ *
+ * In addition ML_DenormalGuard switches the FPU to flush-to-zero/denormals-are-zero
+ * while it exists. The block functions of the reverb, the biquad and ZDF filters and
+ * the exponential envelope create one, a sketch can put one around its whole audio
+ * processing to cover the other modules as well.
+ * The single sample Filter_Process does not flush its state, a loop calling it
+ * should run under a guard.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_DENORMAL_H_
+#define SRC_ML_DENORMAL_H_
+
+
+#include <stdint.h>
+
+#if (defined __SSE__)
+#include <xmmintrin.h>
+#endif
+
+
+/* far below the noise floor of a 24 bit signal (-360 dB) but far above the denormal range */
+#define ML_DENORMAL_DC          1e-18f
+#define ML_DENORMAL_THRESHOLD   1e-15f
+
+
+static inline float ml_flush_denormal(float x)
+{
+    return ((x < ML_DENORMAL_THRESHOLD) && (x > -ML_DENORMAL_THRESHOLD)) ? 0.0f : x;
+}
+
+
+class ML_DenormalGuard
+{
+public:
+    ML_DenormalGuard()
+    {
+#if (defined __SSE__)
+        saved = _mm_getcsr();
+        _mm_setcsr(saved | 0x8040); /* FTZ and DAZ */
+#elif (defined __aarch64__)
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        saved = fpcr;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ULL << 24))); /* FZ */
+#elif (defined __ARM_FP)
+        uint32_t fpscr;
+        __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+        saved = fpscr;
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr | (1UL << 24))); /* FZ */
+#else
+        saved = 0; /* no control available, the flush and DC strategies still apply */
+#endif
+    }
+
+    ~ML_DenormalGuard()
+    {
+#if (defined __SSE__)
+        _mm_setcsr((uint32_t)saved);
+#elif (defined __aarch64__)
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(saved));
+#elif (defined __ARM_FP)
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r"((uint32_t)saved));
+#endif
+    }
+
+private:
+    uint64_t saved;
+};
+
+
+#endif /* SRC_ML_DENORMAL_H_ */
@@ -46,6 +46,7 @@
 
 
 #include "ml_env.h"
+#include "ml_denormal.h"
 
 
 /*
@@ -131,3 +132,388 @@ bool ASRM_Process(const struct adsrT *ctrl, struct adsr_ctrl_t *asr)
     return true;
 }
 
+
+/*
+ * number of steps until a segment reaches its end (including the step which reaches it)
+ * returns left + 1 when the end is not reached within left steps
+ */
+static uint32_t ADSR_Steps(float dist, float rate, uint32_t left)
+{
+    if (dist < 0.0f)
+    {
+        return 1;
+    }
+    if (rate <= 0.0f)
+    {
+        return left + 1;
+    }
+    const float steps = dist / rate;
+    return (steps >= (float)left) ? (left + 1) : ((uint32_t)steps + 1);
+}
+
+static inline void ADSR_Ramp(float *gain, float start, float rate, uint32_t cnt)
+{
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        gain[i] = start + rate * (float)(i + 1);
+    }
+}
+
+/*
+ * the same envelope as ADSR_Process but the segments are calculated as closed form ramps
+ * returns false when the release has ended, the remaining samples are zero
+ */
+static bool ADSR_Render(const struct adsrT *ctrl, float *value, adsr_phaseT *phase, float *gain, uint32_t len)
+{
+    float v = *value;
+    uint32_t n = 0;
+
+    while (n < len)
+    {
+        const uint32_t left = len - n;
+        uint32_t k;
+
+        switch (*phase)
+        {
+        case attack:
+            k = ADSR_Steps(1.0f - v, ctrl->a, left);
+            if (k > left)
+            {
+                ADSR_Ramp(&gain[n], v, ctrl->a, left);
+                v += ctrl->a * left;
+                n = len;
+            }
+            else
+            {
+                ADSR_Ramp(&gain[n], v, ctrl->a, k - 1);
+                v = 1.0f;
+                gain[n + k - 1] = v;
+                *phase = decay;
+                n += k;
+            }
+            break;
+
+        case decay:
+            k = ADSR_Steps(v - ctrl->s, ctrl->d, left);
+            if (k > left)
+            {
+                ADSR_Ramp(&gain[n], v, -ctrl->d, left);
+                v -= ctrl->d * left;
+                n = len;
+            }
+            else
+            {
+                ADSR_Ramp(&gain[n], v, -ctrl->d, k - 1);
+                v = ctrl->s;
+                gain[n + k - 1] = v;
+                *phase = sustain;
+                n += k;
+            }
+            break;
+
+        case sustain:
+            for (; n < len; n++)
+            {
+                gain[n] = v;
+            }
+            break;
+
+        case release:
+            k = ADSR_Steps(v, ctrl->r, left);
+            if (k > left)
+            {
+                ADSR_Ramp(&gain[n], v, -ctrl->r, left);
+                v -= ctrl->r * left;
+                n = len;
+            }
+            else
+            {
+                ADSR_Ramp(&gain[n], v, -ctrl->r, k - 1);
+                for (n += k - 1; n < len; n++)
+                {
+                    gain[n] = 0.0f;
+                }
+                *value = 0.0f;
+                return false;
+            }
+            break;
+        }
+    }
+
+    *value = v;
+    return true;
+}
+
+/*
+ * writes the envelope of a whole block into gain
+ */
+bool ADSR_ProcessBuffer(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr, float *gain, uint32_t len)
+{
+    return ADSR_Render(ctrl, &adsr->ctrl, &adsr->phase, gain, len);
+}
+
+void ADSR_BankInit(struct adsrBankT *bank)
+{
+    for (uint32_t v = 0; v < ADSR_BANK_VOICES; v++)
+    {
+        bank->ctrl[v] = 0.0f;
+        bank->phase[v] = release;
+        bank->param[v] = NULL;
+    }
+    for (uint32_t w = 0; w < ADSR_BANK_WORDS; w++)
+    {
+        bank->active[w] = 0;
+    }
+}
+
+void ADSR_BankStart(struct adsrBankT *bank, uint32_t voice, const struct adsrT *ctrl)
+{
+    if (voice >= ADSR_BANK_VOICES)
+    {
+        return;
+    }
+
+    struct adsr_ctrl_t adsr;
+    ADSR_Start(ctrl, &adsr);
+    bank->ctrl[voice] = adsr.ctrl;
+    bank->phase[voice] = adsr.phase;
+    bank->param[voice] = ctrl;
+    bank->active[voice / 32] |= 1UL << (voice % 32);
+}
+
+void ADSR_BankRelease(struct adsrBankT *bank, uint32_t voice)
+{
+    if (voice < ADSR_BANK_VOICES)
+    {
+        bank->phase[voice] = release;
+    }
+}
+
+void ADSR_BankStop(struct adsrBankT *bank, uint32_t voice)
+{
+    if (voice < ADSR_BANK_VOICES)
+    {
+        bank->ctrl[voice] = 0.0f;
+        bank->phase[voice] = release;
+        bank->active[voice / 32] &= ~(1UL << (voice % 32));
+    }
+}
+
+/*
+ * calculates the envelopes of all active voices, gain of voice v is written to gain[v * len]
+ * voices which have finished their release are written to finished (if not NULL) and deactivated
+ * returns the number of finished voices
+ */
+uint32_t ADSR_BankProcess(struct adsrBankT *bank, float *gain, uint32_t len, uint8_t *finished)
+{
+    uint32_t finishedCnt = 0;
+
+    for (uint32_t w = 0; w < ADSR_BANK_WORDS; w++)
+    {
+        /* idle voices are skipped without touching their data */
+        uint32_t bits = bank->active[w];
+        while (bits != 0)
+        {
+            const uint32_t v = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            adsr_phaseT phase = (adsr_phaseT)bank->phase[v];
+            const bool running = ADSR_Render(bank->param[v], &bank->ctrl[v], &phase, &gain[v * len], len);
+            bank->phase[v] = phase;
+
+            if (!running)
+            {
+                bank->active[w] &= ~(1UL << (v % 32));
+                if (finished != NULL)
+                {
+                    finished[finishedCnt] = v;
+                }
+                finishedCnt++;
+            }
+        }
+    }
+
+    return finishedCnt;
+}
+
+/*
+ * the attack aims at ENV_EXP_OVERSHOOT and ends at 1.0,
+ * its coefficient is looked up with the time scaled by ln(ENV_EXP_FLOOR) / ln((ENV_EXP_OVERSHOOT - 1) / ENV_EXP_OVERSHOOT)
+ */
+#define ENV_EXP_ATTACK_SCALE    5.1403f
+#define ENV_RATE_STEP_BIT       3 /* log2(ENV_RATE_STEPS) */
+
+
+/*
+ * entry j belongs to the time 2^oct * (1 + sub / ENV_RATE_STEPS) ms,
+ * this matches the exponent and the upper mantissa bits of the float time used for the lookup
+ */
+void EnvRate_Init(struct envRateTableT *table, float sampleRate)
+{
+    const float lnFloor = logf(ENV_EXP_FLOOR);
+
+    for (uint32_t j = 0; j < ENV_RATE_CNT; j++)
+    {
+        const int oct = (int)(j / ENV_RATE_STEPS) + ENV_RATE_OCT_MIN;
+        const float sub = (float)(j % ENV_RATE_STEPS) / ENV_RATE_STEPS;
+        const float samples = ldexpf(1.0f + sub, oct) * sampleRate * 0.001f;
+        table->coeff[j] = 1.0f - expf(lnFloor / samples);
+    }
+}
+
+/*
+ * returns the coefficient which lets the envelope fall to ENV_EXP_FLOOR within ms milliseconds
+ */
+float EnvRate_Coeff(const struct envRateTableT *table, float ms)
+{
+    const float msMin = ldexpf(1.0f, ENV_RATE_OCT_MIN);
+    const float msMax = ldexpf(1.0f, ENV_RATE_OCT_MAX);
+    ms = (ms < msMin) ? msMin : ms;
+    ms = (ms > msMax) ? msMax : ms;
+
+    union
+    {
+        float f;
+        uint32_t u;
+    } t;
+    t.f = ms;
+
+    const uint32_t oct = ((t.u >> 23) & 0xFF) - 127 - ENV_RATE_OCT_MIN;
+    const uint32_t mant = t.u & 0x7FFFFF;
+    const uint32_t idx = oct * ENV_RATE_STEPS + (mant >> (23 - ENV_RATE_STEP_BIT));
+
+    if (idx >= ENV_RATE_CNT - 1)
+    {
+        return table->coeff[ENV_RATE_CNT - 1];
+    }
+
+    const float frac = ((float)(mant & ((1UL << (23 - ENV_RATE_STEP_BIT)) - 1))) * (1.0f / (float)(1UL << (23 - ENV_RATE_STEP_BIT)));
+    return table->coeff[idx] + (table->coeff[idx + 1] - table->coeff[idx]) * frac;
+}
+
+void EnvExp_SetAttack(struct envExpT *env, const struct envRateTableT *table, float ms)
+{
+    env->attack = EnvRate_Coeff(table, ms * ENV_EXP_ATTACK_SCALE);
+}
+
+void EnvExp_SetDecay(struct envExpT *env, const struct envRateTableT *table, float ms)
+{
+    env->decay = EnvRate_Coeff(table, ms);
+}
+
+void EnvExp_SetSustain(struct envExpT *env, float level)
+{
+    env->sustain = level;
+}
+
+void EnvExp_SetRelease(struct envExpT *env, const struct envRateTableT *table, float ms)
+{
+    env->release = EnvRate_Coeff(table, ms);
+}
+
+void EnvExp_Start(const struct envExpT *env __attribute__((unused)), struct envExpCtrlT *ctrl)
+{
+    /* a retriggered voice starts from its current level, ctrl must be zero for the first note */
+    ctrl->phase = attack;
+}
+
+void EnvExp_Release(struct envExpCtrlT *ctrl)
+{
+    ctrl->phase = release;
+}
+
+/*
+ * single step, each segment is ctrl += (target - ctrl) * coeff
+ */
+bool EnvExp_Process(const struct envExpT *env, struct envExpCtrlT *ctrl)
+{
+    switch (ctrl->phase)
+    {
+    case attack:
+        ctrl->ctrl += (ENV_EXP_OVERSHOOT - ctrl->ctrl) * env->attack;
+        if (ctrl->ctrl >= 1.0f)
+        {
+            ctrl->ctrl = 1.0f;
+            ctrl->phase = decay;
+        }
+        break;
+    case decay:
+    case sustain:
+        ctrl->ctrl += (env->sustain - ctrl->ctrl) * env->decay;
+        /* a sustain level of zero would decay into denormals */
+        ctrl->ctrl = ml_flush_denormal(ctrl->ctrl);
+        break;
+    case release:
+        ctrl->ctrl -= ctrl->ctrl * env->release;
+        if (ctrl->ctrl < ENV_EXP_FLOOR)
+        {
+            ctrl->ctrl = 0.0f;
+            return false;
+        }
+        break;
+    }
+    return true;
+}
+
+/*
+ * writes the envelope of a whole block into gain, returns false when the release has ended
+ */
+bool EnvExp_ProcessBuffer(const struct envExpT *env, struct envExpCtrlT *ctrl, float *gain, uint32_t len)
+{
+    ML_DenormalGuard denormalGuard;
+
+    float v = ctrl->ctrl;
+    uint32_t n = 0;
+
+    if (ctrl->phase == attack)
+    {
+        const float c = env->attack;
+        for (; n < len; n++)
+        {
+            v += (ENV_EXP_OVERSHOOT - v) * c;
+            if (v >= 1.0f)
+            {
+                gain[n++] = 1.0f;
+                v = 1.0f;
+                ctrl->phase = decay;
+                break;
+            }
+            gain[n] = v;
+        }
+    }
+
+    if ((ctrl->phase == decay) || (ctrl->phase == sustain))
+    {
+        const float c = env->decay;
+        const float s = env->sustain;
+        for (; n < len; n++)
+        {
+            v += (s - v) * c;
+            gain[n] = v;
+        }
+        /* a sustain level of zero would decay into denormals */
+        v = ml_flush_denormal(v);
+    }
+
+    if (ctrl->phase == release)
+    {
+        const float c = env->release;
+        for (; n < len; n++)
+        {
+            v -= v * c;
+            if (v < ENV_EXP_FLOOR)
+            {
+                for (; n < len; n++)
+                {
+                    gain[n] = 0.0f;
+                }
+                ctrl->ctrl = 0.0f;
+                return false;
+            }
+            gain[n] = v;
+        }
+    }
+
+    ctrl->ctrl = v;
+    return true;
+}
@@ -79,11 +79,85 @@ struct asmT
     float r;
 };
 
+/*
+ * envelopes of many voices stored as structure of arrays
+ * only active voices are calculated, finished voices are reported
+ */
+#ifndef ADSR_BANK_VOICES
+#define ADSR_BANK_VOICES    64
+#endif
+
+#if ADSR_BANK_VOICES > 256
+#error "ADSR_BANK_VOICES must not exceed 256, finished voices are reported as uint8_t"
+#endif
+
+#define ADSR_BANK_WORDS ((ADSR_BANK_VOICES + 31) / 32)
+
+struct adsrBankT
+{
+    float ctrl[ADSR_BANK_VOICES];
+    uint8_t phase[ADSR_BANK_VOICES]; /* adsr_phaseT */
+    const struct adsrT *param[ADSR_BANK_VOICES];
+    uint32_t active[ADSR_BANK_WORDS]; /* bit per voice */
+};
+
+/*
+ * exponential envelope with times in milliseconds
+ * - the times are converted into coefficients by a table which is calculated once per sample rate
+ * - the table has ENV_RATE_STEPS entries per octave, the times are looked up without any pow/exp/log call
+ * - attack, decay and release time are the time from 0 to 1, from 1 to sustain and from 1 to ENV_EXP_FLOOR
+ */
+#define ENV_RATE_STEPS      8
+#define ENV_RATE_OCT_MIN    (-3) /* shortest time 0.125 ms */
+#define ENV_RATE_OCT_MAX    18 /* longest time 262 s, attack 51 s */
+#define ENV_RATE_CNT        ((ENV_RATE_OCT_MAX - ENV_RATE_OCT_MIN) * ENV_RATE_STEPS + 1)
+
+#define ENV_EXP_FLOOR       0.0001f /* -80 dB, release ends here */
+#define ENV_EXP_OVERSHOOT   1.2f /* target of the attack, gives the typical curve of an analog envelope */
+
+struct envRateTableT
+{
+    float coeff[ENV_RATE_CNT];
+};
+
+struct envExpT
+{
+    float attack; /* coefficients, set by EnvExp_Set... */
+    float decay;
+    float sustain; /* level 0 .. 1 */
+    float release;
+};
+
+struct envExpCtrlT
+{
+    float ctrl;
+    adsr_phaseT phase; /* decay includes sustain */
+};
+
 
 bool ADSR_Process(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr);
 void ADSR_Start(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr);
 bool ASRM_Process(const struct adsrT *ctrl, struct adsr_ctrl_t *asr);
 void ASRM_Start(const struct adsrT *ctrl, struct adsr_ctrl_t *asr);
 
+bool ADSR_ProcessBuffer(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr, float *gain, uint32_t len);
+
+void ADSR_BankInit(struct adsrBankT *bank);
+void ADSR_BankStart(struct adsrBankT *bank, uint32_t voice, const struct adsrT *ctrl);
+void ADSR_BankRelease(struct adsrBankT *bank, uint32_t voice);
+void ADSR_BankStop(struct adsrBankT *bank, uint32_t voice);
+uint32_t ADSR_BankProcess(struct adsrBankT *bank, float *gain, uint32_t len, uint8_t *finished);
+
+void EnvRate_Init(struct envRateTableT *table, float sampleRate);
+float EnvRate_Coeff(const struct envRateTableT *table, float ms);
+void EnvExp_SetAttack(struct envExpT *env, const struct envRateTableT *table, float ms);
+void EnvExp_SetDecay(struct envExpT *env, const struct envRateTableT *table, float ms);
+void EnvExp_SetSustain(struct envExpT *env, float level);
+void EnvExp_SetRelease(struct envExpT *env, const struct envRateTableT *table, float ms);
+void EnvExp_Start(const struct envExpT *env, struct envExpCtrlT *ctrl);
+void EnvExp_Release(struct envExpCtrlT *ctrl);
+bool EnvExp_Process(const struct envExpT *env, struct envExpCtrlT *ctrl);
+bool EnvExp_ProcessBuffer(const struct envExpT *env, struct envExpCtrlT *ctrl, float *gain, uint32_t len);
+
 
 #endif /* ML_ENV_H_ */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_event.cpp
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains the implementation of the timestamped event queue
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#include "ml_event.h"
+
+
+#define EVENT_QUEUE_MASK    (EVENT_QUEUE_SIZE - 1)
+
+
+void EventQueue_Init(struct eventQueueT *queue, uint32_t sampleRate)
+{
+    queue->rd = 0;
+    queue->wr = 0;
+    queue->now = 0;
+    queue->blockLen = 0;
+    queue->blockMicros = micros();
+    queue->sampleRate = sampleRate;
+    queue->granularity = 1;
+}
+
+/*
+ * a granularity of the vector width (4 or 8) keeps all parts aligned for the SIMD kernels
+ */
+void EventQueue_SetGranularity(struct eventQueueT *queue, uint32_t samples)
+{
+    queue->granularity = (samples > 0) ? samples : 1;
+}
+
+/*
+ * events are kept sorted by time, events with the same time keep their order
+ * returns false when the queue is full
+ */
+bool EventQueue_Push(struct eventQueueT *queue, uint32_t time, uint8_t status, uint8_t data1, uint8_t data2)
+{
+    if (queue->wr - queue->rd >= EVENT_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    /* events arrive mostly in order, the loop is only entered for late ones */
+    uint32_t i = queue->wr;
+    while ((i != queue->rd) && ((int32_t)(queue->ev[(i - 1) & EVENT_QUEUE_MASK].time - time) > 0))
+    {
+        queue->ev[i & EVENT_QUEUE_MASK] = queue->ev[(i - 1) & EVENT_QUEUE_MASK];
+        i--;
+    }
+
+    struct timedEventT *ev = &queue->ev[i & EVENT_QUEUE_MASK];
+    ev->time = time;
+    ev->status = status;
+    ev->data1 = data1;
+    ev->data2 = data2;
+    queue->wr++;
+
+    return true;
+}
+
+/*
+ * converts the time of reception (micros()) into a sample time
+ * the position within the current block is kept, the event is delayed by one block
+ */
+uint32_t EventQueue_Stamp(const struct eventQueueT *queue, uint32_t us)
+{
+    uint32_t offset = (uint32_t)(((uint64_t)(us - queue->blockMicros) * queue->sampleRate) / 1000000UL);
+    offset = (offset > queue->blockLen) ? queue->blockLen : offset;
+    return queue->now + offset;
+}
+
+/*
+ * renders a block of len samples, process is called for each part between two event times
+ * returns the number of parts
+ */
+uint32_t EventQueue_Render(struct eventQueueT *queue, uint32_t len, eventProcessFn process, eventHandleFn handle, void *arg)
+{
+    uint32_t pos = 0;
+    uint32_t parts = 0;
+
+    queue->blockMicros = micros();
+    queue->blockLen = len;
+
+    while (queue->rd != queue->wr)
+    {
+        const struct timedEventT *ev = &queue->ev[queue->rd & EVENT_QUEUE_MASK];
+        const int32_t delta = (int32_t)(ev->time - queue->now);
+
+        if (delta >= (int32_t)len)
+        {
+            break;
+        }
+
+        /* late events are applied at the start of the block */
+        uint32_t offset = (delta > 0) ? (uint32_t)delta : 0;
+        offset -= offset % queue->granularity;
+
+        if (offset > pos)
+        {
+            process(pos, offset - pos, arg);
+            parts++;
+            pos = offset;
+        }
+
+        handle(ev, arg);
+        queue->rd++;
+    }
+
+    if (pos < len)
+    {
+        process(pos, len - pos, arg);
+        parts++;
+    }
+
+    queue->now += len;
+
+    return parts;
+}
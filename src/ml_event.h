@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_event.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains a queue of timestamped events and a render driver
+ * which applies them sample accurate.
+ *
+ * Events (MIDI messages) are stored with the sample time at which they should be applied.
+ * EventQueue_Render splits the block at the event times, calls the process function for
+ * each part and the event handler in between. Events received during a block can be
+ * stamped with EventQueue_Stamp, they are then played with a constant latency of one block
+ * instead of the jitter of a block.
+ *
+ * The queue is not protected against concurrent access, events must be pushed from the
+ * same task which calls EventQueue_Render.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_EVENT_H_
+#define SRC_ML_EVENT_H_
+
+
+#include <Arduino.h>
+
+
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE    64
+#endif
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) != 0
+#error "EVENT_QUEUE_SIZE must be a power of two"
+#endif
+
+struct timedEventT
+{
+    uint32_t time; /* sample time */
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+};
+
+struct eventQueueT
+{
+    struct timedEventT ev[EVENT_QUEUE_SIZE];
+    uint32_t rd;
+    uint32_t wr;
+
+    uint32_t now; /* sample time of the start of the next block */
+    uint32_t blockLen; /* length of the last rendered block */
+    uint32_t blockMicros; /* micros() at the start of the last rendered block */
+    uint32_t sampleRate;
+    uint32_t granularity; /* events are applied at multiples of this, 1: sample accurate */
+};
+
+typedef void (*eventProcessFn)(uint32_t offset, uint32_t len, void *arg);
+typedef void (*eventHandleFn)(const struct timedEventT *ev, void *arg);
+
+
+void EventQueue_Init(struct eventQueueT *queue, uint32_t sampleRate);
+void EventQueue_SetGranularity(struct eventQueueT *queue, uint32_t samples);
+bool EventQueue_Push(struct eventQueueT *queue, uint32_t time, uint8_t status, uint8_t data1, uint8_t data2);
+uint32_t EventQueue_Stamp(const struct eventQueueT *queue, uint32_t us);
+uint32_t EventQueue_Render(struct eventQueueT *queue, uint32_t len, eventProcessFn process, eventHandleFn handle, void *arg);
+
+
+#endif /* SRC_ML_EVENT_H_ */
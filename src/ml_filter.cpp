@@ -46,17 +46,14 @@
 
 
 #include "ml_filter.h"
-#include "ml_waveform.h"
+#include "ml_denormal.h"
+#include "ml_trig.h"
 
 #ifndef ARDUINO
 #include <math.h>
 #endif
 
 
-/* will be removed in future */
-extern float *sine;
-
-
 void Filter_Init(struct filterProcT *const filterP, struct filterCoeffT *const filterC)
 {
     filterP->w[0] = 0.0f;
@@ -103,6 +100,8 @@ void Filter_Process(float *const signal, struct filterProcT *const filterP)
 
 void Filter_Process_Buffer(float *const signal, struct filterProcT *const filterP, uint32_t len)
 {
+    ML_DenormalGuard denormalGuard;
+
     for (uint32_t n = 0; n < len; n++)
     {
         const float out = filterP->filterCoeff->bNorm[0] * signal[n] + filterP->w[0];
@@ -110,6 +109,863 @@ void Filter_Process_Buffer(float *const signal, struct filterProcT *const filter
         filterP->w[1] = filterP->filterCoeff->bNorm[2] * signal[n] - filterP->filterCoeff->aNorm[1] * out;
         signal[n] = out;
     }
+
+    /* the state decays into denormals after the input stops */
+    filterP->w[0] = ml_flush_denormal(filterP->w[0]);
+    filterP->w[1] = ml_flush_denormal(filterP->w[1]);
+}
+
+/*
+ * the coefficients of filterP->filterCoeff are moved to target within the block,
+ * at the end target is copied into filterP->filterCoeff
+ */
+void Filter_Process_BufferRamp(float *const signal, struct filterProcT *const filterP, const struct filterCoeffT *target, uint32_t len)
+{
+    ML_DenormalGuard denormalGuard;
+
+    struct filterCoeffT *const filterC = filterP->filterCoeff;
+
+    if (len == 0)
+    {
+        return;
+    }
+
+    const float step = 1.0f / ((float)len);
+    float coef[5];
+    float coefStep[5];
+    for (int i = 0; i < 5; i++)
+    {
+        coef[i] = filterC->coef[i];
+        coefStep[i] = (target->coef[i] - filterC->coef[i]) * step;
+    }
+
+    float w0 = filterP->w[0];
+    float w1 = filterP->w[1];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            coef[i] += coefStep[i];
+        }
+
+        /* coef: b0, b1, b2, a1, a2 */
+        const float out = coef[0] * signal[n] + w0;
+        w0 = coef[1] * signal[n] - coef[3] * out + w1;
+        w1 = coef[2] * signal[n] - coef[4] * out;
+        signal[n] = out;
+    }
+
+    filterP->w[0] = ml_flush_denormal(w0);
+    filterP->w[1] = ml_flush_denormal(w1);
+    *filterC = *target;
+}
+
+void Filter_Cache_Init(struct filterCacheT *cache, float resoMin, float resoMax)
+{
+    for (uint32_t r = 0; r < FILTER_CACHE_RESO_STEPS; r++)
+    {
+        for (uint32_t w = 0; w < (FILTER_CACHE_CUTOFF_STEPS + 31) / 32; w++)
+        {
+            cache->valid[r][w] = 0;
+        }
+    }
+    cache->resoMin = resoMin;
+    cache->resoScale = (resoMax > resoMin) ? ((FILTER_CACHE_RESO_STEPS - 1) / (resoMax - resoMin)) : 0.0f;
+}
+
+/*
+ * returns the coefficients of the nearest grid point, the result can be used with Filter_Process_BufferRamp
+ */
+const struct filterCoeffT *Filter_Cache_Get(struct filterCacheT *cache, float c, float reso)
+{
+    float ci = c * (FILTER_CACHE_CUTOFF_STEPS - 1) + 0.5f;
+    ci = (ci < 0.0f) ? 0.0f : ci;
+    ci = (ci > (float)(FILTER_CACHE_CUTOFF_STEPS - 1)) ? (float)(FILTER_CACHE_CUTOFF_STEPS - 1) : ci;
+    float ri = (reso - cache->resoMin) * cache->resoScale + 0.5f;
+    ri = (ri < 0.0f) ? 0.0f : ri;
+    ri = (ri > (float)(FILTER_CACHE_RESO_STEPS - 1)) ? (float)(FILTER_CACHE_RESO_STEPS - 1) : ri;
+
+    const uint32_t cIdx = (uint32_t)ci;
+    const uint32_t rIdx = (uint32_t)ri;
+    struct filterCoeffT *coeff = &cache->coeff[rIdx][cIdx];
+
+    if ((cache->valid[rIdx][cIdx / 32] & (1UL << (cIdx % 32))) == 0)
+    {
+        const float cQ = ((float)cIdx) / (FILTER_CACHE_CUTOFF_STEPS - 1);
+        const float resoQ = (cache->resoScale > 0.0f) ? (cache->resoMin + ((float)rIdx) / cache->resoScale) : cache->resoMin;
+        Filter_Calculate(cQ, resoQ, coeff);
+        cache->valid[rIdx][cIdx / 32] |= 1UL << (cIdx % 32);
+    }
+
+    return coeff;
+}
+
+void FilterFix_Init(struct filterFixProcT *const filterP, const struct filterFixCoeffT *filterC, bool noiseShaping)
+{
+    filterP->filterCoeff = filterC;
+    filterP->noiseShaping = noiseShaping;
+    FilterFix_Reset(filterP);
+}
+
+void FilterFix_Reset(struct filterFixProcT *const filterP)
+{
+    filterP->x1 = 0;
+    filterP->x2 = 0;
+    filterP->y1 = 0;
+    filterP->y2 = 0;
+    filterP->err = 0;
+}
+
+static int16_t FilterFix_Q14(float v)
+{
+    v = v * (1 << FILTER_FIX_SHIFT);
+    v = (v >= 0.0f) ? (v + 0.5f) : (v - 0.5f);
+    v = (v > 32767.0f) ? 32767.0f : v;
+    v = (v < -32768.0f) ? -32768.0f : v;
+    return (int16_t)v;
+}
+
+/*
+ * converts the result of Filter_Calculate, a1 = -2 * cos(omega) can reach -2.0 but not +2.0
+ */
+void FilterFix_SetCoeff(struct filterFixCoeffT *const filterC, const struct filterCoeffT *src)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        filterC->b[i] = FilterFix_Q14(src->bNorm[i]);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        filterC->a[i] = FilterFix_Q14(src->aNorm[i]);
+    }
+}
+
+/*
+ * the sum is calculated unsigned, overflows of intermediate results cancel out as long as the result fits.
+ * on Cortex-M0+ (RP2040, SAMD21: single cycle 32 bit multiply, no long multiply) this is expected
+ * to take about 30 to 40 cycles per sample, most of them are loads of coefficients and state
+ * because only 8 low registers are available
+ */
+void FilterFix_Process_Buffer(Q1_14 *const signal, struct filterFixProcT *const filterP, uint32_t len)
+{
+    const struct filterFixCoeffT *c = filterP->filterCoeff;
+    const int32_t b0 = c->b[0];
+    const int32_t b1 = c->b[1];
+    const int32_t b2 = c->b[2];
+    const int32_t a1 = c->a[0];
+    const int32_t a2 = c->a[1];
+    int32_t x1 = filterP->x1;
+    int32_t x2 = filterP->x2;
+    int32_t y1 = filterP->y1;
+    int32_t y2 = filterP->y2;
+    int32_t err = filterP->err;
+
+    /* without noise shaping the result is rounded */
+    const int32_t mask = filterP->noiseShaping ? ((1L << FILTER_FIX_SHIFT) - 1) : 0;
+    const int32_t round = filterP->noiseShaping ? 0 : (1L << (FILTER_FIX_SHIFT - 1));
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        const int32_t x0 = signal[n].s16;
+        uint32_t acc = (uint32_t)(b0 * x0) + (uint32_t)(b1 * x1) + (uint32_t)(b2 * x2);
+        acc -= (uint32_t)(a1 * y1) + (uint32_t)(a2 * y2);
+        acc += (uint32_t)(err + round);
+
+        int32_t y = ((int32_t)acc) >> FILTER_FIX_SHIFT;
+        err = ((int32_t)acc) & mask;
+        if (y > INT16_MAX)
+        {
+            y = INT16_MAX;
+            err = 0;
+        }
+        else if (y < INT16_MIN)
+        {
+            y = INT16_MIN;
+            err = 0;
+        }
+
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y;
+        signal[n].s16 = (int16_t)y;
+    }
+
+    filterP->x1 = x1;
+    filterP->x2 = x2;
+    filterP->y1 = y1;
+    filterP->y2 = y2;
+    filterP->err = err;
+}
+
+void FilterBank_Init(struct filterBankT *bank)
+{
+    struct filterCoeffT coeff;
+    Filter_Coeff_Init(&coeff);
+
+    for (uint32_t v = 0; v < FILTER_BANK_GROUPS * FILTER_BANK_LANES; v++)
+    {
+        FilterBank_SetCoeff(bank, v, &coeff);
+        FilterBank_Reset(bank, v);
+    }
+}
+
+/*
+ * the coefficients are copied, use Filter_Calculate to get them
+ */
+void FilterBank_SetCoeff(struct filterBankT *bank, uint32_t voice, const struct filterCoeffT *filterC)
+{
+    if (voice >= FILTER_BANK_GROUPS * FILTER_BANK_LANES)
+    {
+        return;
+    }
+
+    struct filterLaneT *lane = &bank->lane[voice / FILTER_BANK_LANES];
+    const uint32_t l = voice % FILTER_BANK_LANES;
+    lane->b0[l] = filterC->bNorm[0];
+    lane->b1[l] = filterC->bNorm[1];
+    lane->b2[l] = filterC->bNorm[2];
+    lane->a1[l] = filterC->aNorm[0];
+    lane->a2[l] = filterC->aNorm[1];
+}
+
+void FilterBank_Reset(struct filterBankT *bank, uint32_t voice)
+{
+    if (voice >= FILTER_BANK_GROUPS * FILTER_BANK_LANES)
+    {
+        return;
+    }
+
+    struct filterLaneT *lane = &bank->lane[voice / FILTER_BANK_LANES];
+    lane->w0[voice % FILTER_BANK_LANES] = 0.0f;
+    lane->w1[voice % FILTER_BANK_LANES] = 0.0f;
+}
+
+/*
+ * processes the voices of a lane group, signal is interleaved: signal[n * FILTER_BANK_LANES + l]
+ */
+void FilterBank_ProcessGroup(struct filterBankT *bank, uint32_t group, float *signal, uint32_t len)
+{
+    ML_DenormalGuard denormalGuard;
+
+    struct filterLaneT *lane = &bank->lane[group];
+
+#if ML_SIMD
+    const ml_vf b0 = ml_vf_load(lane->b0);
+    const ml_vf b1 = ml_vf_load(lane->b1);
+    const ml_vf b2 = ml_vf_load(lane->b2);
+    const ml_vf a1 = ml_vf_load(lane->a1);
+    const ml_vf a2 = ml_vf_load(lane->a2);
+    ml_vf w0 = ml_vf_load(lane->w0);
+    ml_vf w1 = ml_vf_load(lane->w1);
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        float *x = &signal[n * FILTER_BANK_LANES];
+        const ml_vf in = ml_vf_load(x);
+        const ml_vf out = ml_vf_madd(w0, b0, in);
+        w0 = ml_vf_sub(ml_vf_madd(w1, b1, in), ml_vf_mul(a1, out));
+        w1 = ml_vf_sub(ml_vf_mul(b2, in), ml_vf_mul(a2, out));
+        ml_vf_store(x, out);
+    }
+
+    ml_vf_store(lane->w0, w0);
+    ml_vf_store(lane->w1, w1);
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        lane->w0[l] = ml_flush_denormal(lane->w0[l]);
+        lane->w1[l] = ml_flush_denormal(lane->w1[l]);
+    }
+#else
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        const float b0 = lane->b0[l];
+        const float b1 = lane->b1[l];
+        const float b2 = lane->b2[l];
+        const float a1 = lane->a1[l];
+        const float a2 = lane->a2[l];
+        float w0 = lane->w0[l];
+        float w1 = lane->w1[l];
+
+        for (uint32_t n = 0; n < len; n++)
+        {
+            float *x = &signal[n * FILTER_BANK_LANES + l];
+            const float out = b0 * (*x) + w0;
+            w0 = b1 * (*x) - a1 * out + w1;
+            w1 = b2 * (*x) - a2 * out;
+            *x = out;
+        }
+
+        lane->w0[l] = ml_flush_denormal(w0);
+        lane->w1[l] = ml_flush_denormal(w1);
+    }
+#endif
+}
+
+/*
+ * filters the buffer of each voice in place, signal[v] can be NULL for unused voices
+ */
+void FilterBank_Process(struct filterBankT *bank, float *const *signal, uint32_t len)
+{
+    ML_DenormalGuard denormalGuard;
+
+#if ML_SIMD
+    /* unused lanes read silence and write into discard */
+    static const float silence[FILTER_BANK_LANES] = {0};
+    float discard[FILTER_BANK_LANES];
+
+    for (uint32_t g = 0; g < FILTER_BANK_GROUPS; g++)
+    {
+        const float *in[FILTER_BANK_LANES];
+        float *out[FILTER_BANK_LANES];
+        uint32_t step[FILTER_BANK_LANES];
+        bool used = false;
+
+        for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+        {
+            const uint32_t v = g * FILTER_BANK_LANES + l;
+            const bool valid = (v < FILTER_BANK_VOICES) && (signal[v] != NULL);
+            in[l] = valid ? signal[v] : silence;
+            out[l] = valid ? signal[v] : discard;
+            step[l] = valid ? FILTER_BANK_LANES : 0;
+            used |= valid;
+        }
+        if (!used)
+        {
+            continue;
+        }
+
+        struct filterLaneT *lane = &bank->lane[g];
+        const ml_vf b0 = ml_vf_load(lane->b0);
+        const ml_vf b1 = ml_vf_load(lane->b1);
+        const ml_vf b2 = ml_vf_load(lane->b2);
+        const ml_vf a1 = ml_vf_load(lane->a1);
+        const ml_vf a2 = ml_vf_load(lane->a2);
+        ml_vf w0 = ml_vf_load(lane->w0);
+        ml_vf w1 = ml_vf_load(lane->w1);
+
+        /*
+         * FILTER_BANK_LANES samples of all voices are loaded and transposed in registers,
+         * x[k] then holds sample k of every voice
+         */
+        const uint32_t lenV = len - (len % FILTER_BANK_LANES);
+        for (uint32_t n = 0; n < lenV; n += FILTER_BANK_LANES)
+        {
+            ml_vf x[FILTER_BANK_LANES];
+            for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+            {
+                x[l] = ml_vf_load(in[l]);
+                in[l] += step[l];
+            }
+            ml_vf_transpose(x);
+
+            for (uint32_t k = 0; k < FILTER_BANK_LANES; k++)
+            {
+                const ml_vf y = ml_vf_madd(w0, b0, x[k]);
+                w0 = ml_vf_sub(ml_vf_madd(w1, b1, x[k]), ml_vf_mul(a1, y));
+                w1 = ml_vf_sub(ml_vf_mul(b2, x[k]), ml_vf_mul(a2, y));
+                x[k] = y;
+            }
+
+            ml_vf_transpose(x);
+            for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+            {
+                ml_vf_store(out[l], x[l]);
+                out[l] += step[l];
+            }
+        }
+
+        ml_vf_store(lane->w0, w0);
+        ml_vf_store(lane->w1, w1);
+
+        /* remaining samples are calculated per voice */
+        for (uint32_t l = 0; (l < FILTER_BANK_LANES) && (lenV < len); l++)
+        {
+            if (step[l] == 0)
+            {
+                continue;
+            }
+
+            float *x = out[l];
+            for (uint32_t n = 0; n < len - lenV; n++)
+            {
+                const float y = lane->b0[l] * x[n] + lane->w0[l];
+                lane->w0[l] = lane->b1[l] * x[n] - lane->a1[l] * y + lane->w1[l];
+                lane->w1[l] = lane->b2[l] * x[n] - lane->a2[l] * y;
+                x[n] = y;
+            }
+        }
+
+        for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+        {
+            lane->w0[l] = ml_flush_denormal(lane->w0[l]);
+            lane->w1[l] = ml_flush_denormal(lane->w1[l]);
+        }
+    }
+#else
+    /* the lanes are processed one after another directly in the buffers */
+    for (uint32_t v = 0; v < FILTER_BANK_VOICES; v++)
+    {
+        if (signal[v] == NULL)
+        {
+            continue;
+        }
+
+        struct filterLaneT *lane = &bank->lane[v / FILTER_BANK_LANES];
+        const uint32_t l = v % FILTER_BANK_LANES;
+        const float b0 = lane->b0[l];
+        const float b1 = lane->b1[l];
+        const float b2 = lane->b2[l];
+        const float a1 = lane->a1[l];
+        const float a2 = lane->a2[l];
+        float w0 = lane->w0[l];
+        float w1 = lane->w1[l];
+        float *x = signal[v];
+
+        for (uint32_t n = 0; n < len; n++)
+        {
+            const float out = b0 * x[n] + w0;
+            w0 = b1 * x[n] - a1 * out + w1;
+            w1 = b2 * x[n] - a2 * out;
+            x[n] = out;
+        }
+
+        lane->w0[l] = ml_flush_denormal(w0);
+        lane->w1[l] = ml_flush_denormal(w1);
+    }
+#endif
+}
+
+/*
+ * tan(pi * f) as ratio n / d of the [5/4] pade approximation
+ * relative error is below 3e-4 up to FILTER_ZDF_CUTOFF_MAX, the coefficients use n and d directly,
+ * so no division by zero can happen close to the nyquist frequency
+ */
+static inline void ZdfWarp(float f, float *n, float *d)
+{
+    f = (f < 0.0f) ? 0.0f : ((f > FILTER_ZDF_CUTOFF_MAX) ? FILTER_ZDF_CUTOFF_MAX : f);
+    const float x = f * (float)M_PI;
+    const float x2 = x * x;
+    *n = x * (945.0f - 105.0f * x2 + x2 * x2);
+    *d = 945.0f - 420.0f * x2 + 15.0f * x2 * x2;
+}
+
+#if ML_SIMD
+static inline void ZdfWarp(ml_vf f, ml_vf *n, ml_vf *d)
+{
+    f = ml_vf_min(ml_vf_max(f, ml_vf_set1(0.0f)), ml_vf_set1(FILTER_ZDF_CUTOFF_MAX));
+    const ml_vf x = ml_vf_mul(f, ml_vf_set1((float)M_PI));
+    const ml_vf x2 = ml_vf_mul(x, x);
+    const ml_vf x4 = ml_vf_mul(x2, x2);
+    *n = ml_vf_mul(x, ml_vf_add(ml_vf_madd(ml_vf_set1(945.0f), ml_vf_set1(-105.0f), x2), x4));
+    *d = ml_vf_madd(ml_vf_madd(ml_vf_set1(945.0f), ml_vf_set1(-420.0f), x2), ml_vf_set1(15.0f), x4);
+}
+#endif
+
+/*
+ * state variable filter, g = tan(pi * fc / fs)
+ * c[0] = 1 / (1 + g * (g + k)), c[1] = g * c[0], c[2] = g * c[1]
+ * outputs are y[0] = low pass, y[1] = band pass, y[2] = high pass
+ */
+struct zdfSvfK
+{
+    static inline void Coeff(float f, float k, float *c)
+    {
+        float n, d;
+        ZdfWarp(f, &n, &d);
+        const float r = 1.0f / (d * d + n * n + k * n * d);
+        c[0] = d * d * r;
+        c[1] = n * d * r;
+        c[2] = n * n * r;
+    }
+
+    static inline void Tick(const float *c, float k, float *s, float x, float *y)
+    {
+        const float v3 = x - s[1];
+        const float v1 = c[0] * s[0] + c[1] * v3;
+        const float v2 = s[1] + c[1] * s[0] + c[2] * v3;
+        s[0] = 2.0f * v1 - s[0];
+        s[1] = 2.0f * v2 - s[1];
+        y[0] = v2;
+        y[1] = v1;
+        y[2] = x - k * v1 - v2;
+    }
+
+#if ML_SIMD
+    static inline void Coeff(ml_vf f, ml_vf k, ml_vf *c)
+    {
+        ml_vf n, d;
+        ZdfWarp(f, &n, &d);
+        const ml_vf nd = ml_vf_mul(n, d);
+        const ml_vf r = ml_vf_div(ml_vf_set1(1.0f), ml_vf_madd(ml_vf_madd(ml_vf_mul(d, d), n, n), k, nd));
+        c[0] = ml_vf_mul(ml_vf_mul(d, d), r);
+        c[1] = ml_vf_mul(nd, r);
+        c[2] = ml_vf_mul(ml_vf_mul(n, n), r);
+    }
+
+    static inline void Tick(const ml_vf *c, ml_vf k, ml_vf *s, ml_vf x, ml_vf *y)
+    {
+        const ml_vf v3 = ml_vf_sub(x, s[1]);
+        const ml_vf v1 = ml_vf_madd(ml_vf_mul(c[0], s[0]), c[1], v3);
+        const ml_vf v2 = ml_vf_madd(ml_vf_madd(s[1], c[1], s[0]), c[2], v3);
+        s[0] = ml_vf_sub(ml_vf_add(v1, v1), s[0]);
+        s[1] = ml_vf_sub(ml_vf_add(v2, v2), s[1]);
+        y[0] = v2;
+        y[1] = v1;
+        y[2] = ml_vf_sub(ml_vf_sub(x, ml_vf_mul(k, v1)), v2);
+    }
+#endif
+};
+
+/*
+ * 4 pole ladder of one pole stages, the feedback loop is solved instead of delayed
+ * c[0] = g / (1 + g), c[1] = 1 / (1 + g), c[2] = 1 / (1 + k * c[0]^4)
+ * outputs are y[0] = 24 dB low pass, y[1] = 12 dB low pass, y[2] = 24 dB high pass
+ */
+struct zdfLadderK
+{
+    static inline void Coeff(float f, float k, float *c)
+    {
+        float n, d;
+        ZdfWarp(f, &n, &d);
+        const float r = 1.0f / (n + d);
+        const float g2 = n * r * n * r;
+        c[0] = n * r;
+        c[1] = d * r;
+        c[2] = 1.0f / (1.0f + k * g2 * g2);
+    }
+
+    static inline void Tick(const float *c, float k, float *s, float x, float *y)
+    {
+        const float G = c[0];
+        const float sigma = c[1] * (G * (G * (G * s[0] + s[1]) + s[2]) + s[3]);
+        const float u = (x - k * sigma) * c[2];
+        float v;
+
+        v = (u - s[0]) * G;
+        const float y1 = v + s[0];
+        s[0] = y1 + v;
+        v = (y1 - s[1]) * G;
+        const float y2 = v + s[1];
+        s[1] = y2 + v;
+        v = (y2 - s[2]) * G;
+        const float y3 = v + s[2];
+        s[2] = y3 + v;
+        v = (y3 - s[3]) * G;
+        const float y4 = v + s[3];
+        s[3] = y4 + v;
+
+        y[0] = y4;
+        y[1] = y2;
+        y[2] = u - 4.0f * y1 + 6.0f * y2 - 4.0f * y3 + y4;
+    }
+
+#if ML_SIMD
+    static inline void Coeff(ml_vf f, ml_vf k, ml_vf *c)
+    {
+        ml_vf n, d;
+        ZdfWarp(f, &n, &d);
+        const ml_vf r = ml_vf_div(ml_vf_set1(1.0f), ml_vf_add(n, d));
+        c[0] = ml_vf_mul(n, r);
+        c[1] = ml_vf_mul(d, r);
+        const ml_vf g2 = ml_vf_mul(c[0], c[0]);
+        c[2] = ml_vf_div(ml_vf_set1(1.0f), ml_vf_madd(ml_vf_set1(1.0f), k, ml_vf_mul(g2, g2)));
+    }
+
+    static inline ml_vf Stage(ml_vf G, ml_vf *s, ml_vf x)
+    {
+        const ml_vf v = ml_vf_mul(ml_vf_sub(x, *s), G);
+        const ml_vf y = ml_vf_add(v, *s);
+        *s = ml_vf_add(y, v);
+        return y;
+    }
+
+    static inline void Tick(const ml_vf *c, ml_vf k, ml_vf *s, ml_vf x, ml_vf *y)
+    {
+        const ml_vf G = c[0];
+        const ml_vf sigma = ml_vf_mul(c[1], ml_vf_madd(s[3], G, ml_vf_madd(s[2], G, ml_vf_madd(s[1], G, s[0]))));
+        const ml_vf u = ml_vf_mul(ml_vf_sub(x, ml_vf_mul(k, sigma)), c[2]);
+        const ml_vf y1 = Stage(G, &s[0], u);
+        const ml_vf y2 = Stage(G, &s[1], y1);
+        const ml_vf y3 = Stage(G, &s[2], y2);
+        const ml_vf y4 = Stage(G, &s[3], y3);
+
+        y[0] = y4;
+        y[1] = y2;
+        const ml_vf odd = ml_vf_mul(ml_vf_set1(4.0f), ml_vf_add(y1, y3));
+        y[2] = ml_vf_add(ml_vf_sub(ml_vf_madd(u, ml_vf_set1(6.0f), y2), odd), y4);
+    }
+#endif
+};
+
+/*
+ * common processing of both filter types, out[o] can be NULL when the response is not required
+ * cutoff can be NULL or contain NULL for voices without modulation, then the static cutoff is used
+ */
+template<class K>
+static void ZdfBank_ProcessT(struct zdfBankT *bank, const float *const *in, float *const *const *out, const float *const *cutoff, uint32_t len)
+{
+#if ML_SIMD
+    static const float silence[FILTER_BANK_LANES] = {0};
+    float discard[FILTER_BANK_LANES];
+
+    for (uint32_t g = 0; g < FILTER_BANK_GROUPS; g++)
+    {
+        struct zdfLaneT *lane = &bank->lane[g];
+        const float *src[FILTER_BANK_LANES];
+        const float *cut[FILTER_BANK_LANES];
+        float *dst[3][FILTER_BANK_LANES];
+        uint32_t step[FILTER_BANK_LANES];
+        uint32_t cutStep[FILTER_BANK_LANES];
+        float fixed[FILTER_BANK_LANES][FILTER_BANK_LANES];
+        bool used = false;
+        bool mod = false;
+
+        for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+        {
+            const uint32_t v = g * FILTER_BANK_LANES + l;
+            const bool valid = (v < FILTER_BANK_VOICES) && (in[v] != NULL);
+            const bool modV = valid && (cutoff != NULL) && (cutoff[v] != NULL);
+            src[l] = valid ? in[v] : silence;
+            step[l] = valid ? FILTER_BANK_LANES : 0;
+            for (uint32_t o = 0; o < 3; o++)
+            {
+                dst[o][l] = (valid && (out[o] != NULL)) ? out[o][v] : discard;
+            }
+            for (uint32_t k = 0; k < FILTER_BANK_LANES; k++)
+            {
+                fixed[l][k] = lane->cutoff[l];
+            }
+            cut[l] = modV ? cutoff[v] : fixed[l];
+            cutStep[l] = modV ? FILTER_BANK_LANES : 0;
+            used |= valid;
+            mod |= modV;
+        }
+        if (!used)
+        {
+            continue;
+        }
+
+        const ml_vf k = ml_vf_load(lane->k);
+        ml_vf s[4];
+        ml_vf c[3];
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            s[i] = ml_vf_load(lane->s[i]);
+        }
+        K::Coeff(ml_vf_load(lane->cutoff), k, c);
+
+        const uint32_t lenV = len - (len % FILTER_BANK_LANES);
+        for (uint32_t n = 0; n < lenV; n += FILTER_BANK_LANES)
+        {
+            ml_vf x[FILTER_BANK_LANES];
+            ml_vf f[FILTER_BANK_LANES];
+            ml_vf y[3][FILTER_BANK_LANES];
+
+            for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+            {
+                x[l] = ml_vf_load(src[l]);
+                src[l] += step[l];
+            }
+            ml_vf_transpose(x);
+            if (mod)
+            {
+                for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+                {
+                    f[l] = ml_vf_load(cut[l]);
+                    cut[l] += cutStep[l];
+                }
+                ml_vf_transpose(f);
+            }
+
+            for (uint32_t j = 0; j < FILTER_BANK_LANES; j++)
+            {
+                ml_vf yj[3];
+                if (mod)
+                {
+                    K::Coeff(f[j], k, c);
+                }
+                K::Tick(c, k, s, x[j], yj);
+                y[0][j] = yj[0];
+                y[1][j] = yj[1];
+                y[2][j] = yj[2];
+            }
+
+            for (uint32_t o = 0; o < 3; o++)
+            {
+                if (out[o] == NULL)
+                {
+                    continue;
+                }
+                ml_vf_transpose(y[o]);
+                for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+                {
+                    ml_vf_store(dst[o][l], y[o][l]);
+                    dst[o][l] += step[l];
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            ml_vf_store(lane->s[i], s[i]);
+        }
+
+        /* remaining samples are calculated per voice */
+        for (uint32_t l = 0; (l < FILTER_BANK_LANES) && (lenV < len); l++)
+        {
+            if (step[l] == 0)
+            {
+                continue;
+            }
+
+            float sl[4] = {lane->s[0][l], lane->s[1][l], lane->s[2][l], lane->s[3][l]};
+            float cl[3];
+            K::Coeff(lane->cutoff[l], lane->k[l], cl);
+            for (uint32_t n = 0; n < len - lenV; n++)
+            {
+                float yl[3];
+                if (cutStep[l] != 0)
+                {
+                    K::Coeff(cut[l][n], lane->k[l], cl);
+                }
+                K::Tick(cl, lane->k[l], sl, src[l][n], yl);
+                for (uint32_t o = 0; o < 3; o++)
+                {
+                    dst[o][l][n] = yl[o];
+                }
+            }
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                lane->s[i][l] = sl[i];
+            }
+        }
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+            {
+                lane->s[i][l] = ml_flush_denormal(lane->s[i][l]);
+            }
+        }
+    }
+#else
+    for (uint32_t v = 0; v < FILTER_BANK_VOICES; v++)
+    {
+        if (in[v] == NULL)
+        {
+            continue;
+        }
+
+        struct zdfLaneT *lane = &bank->lane[v / FILTER_BANK_LANES];
+        const uint32_t l = v % FILTER_BANK_LANES;
+        const float *cut = (cutoff != NULL) ? cutoff[v] : NULL;
+        const float k = lane->k[l];
+        float s[4] = {lane->s[0][l], lane->s[1][l], lane->s[2][l], lane->s[3][l]};
+        float c[3];
+        K::Coeff(lane->cutoff[l], k, c);
+
+        for (uint32_t n = 0; n < len; n++)
+        {
+            float y[3];
+            if (cut != NULL)
+            {
+                K::Coeff(cut[n], k, c);
+            }
+            K::Tick(c, k, s, in[v][n], y);
+            for (uint32_t o = 0; o < 3; o++)
+            {
+                if (out[o] != NULL)
+                {
+                    out[o][v][n] = y[o];
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            lane->s[i][l] = ml_flush_denormal(s[i]);
+        }
+    }
+#endif
+}
+
+void ZdfBank_Init(struct zdfBankT *bank)
+{
+    for (uint32_t v = 0; v < FILTER_BANK_GROUPS * FILTER_BANK_LANES; v++)
+    {
+        ZdfBank_SetSvf(bank, v, FILTER_ZDF_CUTOFF_MAX, 0.7071f);
+        ZdfBank_Reset(bank, v);
+    }
+}
+
+void ZdfBank_Reset(struct zdfBankT *bank, uint32_t voice)
+{
+    if (voice >= FILTER_BANK_GROUPS * FILTER_BANK_LANES)
+    {
+        return;
+    }
+
+    struct zdfLaneT *lane = &bank->lane[voice / FILTER_BANK_LANES];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        lane->s[i][voice % FILTER_BANK_LANES] = 0.0f;
+    }
+}
+
+/*
+ * cutoff is fc / fs, q is the quality factor (0.5 .. infinite, 0.7071 is flat)
+ */
+void ZdfBank_SetSvf(struct zdfBankT *bank, uint32_t voice, float cutoff, float q)
+{
+    if (voice >= FILTER_BANK_GROUPS * FILTER_BANK_LANES)
+    {
+        return;
+    }
+
+    struct zdfLaneT *lane = &bank->lane[voice / FILTER_BANK_LANES];
+    lane->cutoff[voice % FILTER_BANK_LANES] = cutoff;
+    lane->k[voice % FILTER_BANK_LANES] = (q > 0.01f) ? (1.0f / q) : 100.0f;
+}
+
+/*
+ * cutoff is fc / fs, reso is 0 .. 1, the ladder self oscillates at 1
+ */
+void ZdfBank_SetLadder(struct zdfBankT *bank, uint32_t voice, float cutoff, float reso)
+{
+    if (voice >= FILTER_BANK_GROUPS * FILTER_BANK_LANES)
+    {
+        return;
+    }
+
+    struct zdfLaneT *lane = &bank->lane[voice / FILTER_BANK_LANES];
+    lane->cutoff[voice % FILTER_BANK_LANES] = cutoff;
+    lane->k[voice % FILTER_BANK_LANES] = 4.0f * reso;
+}
+
+/*
+ * filters the buffer of each voice, in[v] can be NULL for unused voices
+ * lp, bp, hp and cutoff can be NULL, cutoff[v] is the per sample cutoff of voice v
+ * input and output buffers can be the same
+ */
+void ZdfBank_ProcessSvf(struct zdfBankT *bank, const float *const *in, float *const *lp, float *const *bp, float *const *hp, const float *const *cutoff, uint32_t len)
+{
+    ML_DenormalGuard denormalGuard;
+
+    float *const *out[3] = {lp, bp, hp};
+    ZdfBank_ProcessT<zdfSvfK>(bank, in, out, cutoff, len);
+}
+
+/*
+ * same as ZdfBank_ProcessSvf but with the outputs of the ladder
+ */
+void ZdfBank_ProcessLadder(struct zdfBankT *bank, const float *const *in, float *const *lp4, float *const *lp2, float *const *hp4, const float *const *cutoff, uint32_t len)
+{
+    ML_DenormalGuard denormalGuard;
+
+    float *const *out[3] = {lp4, lp2, hp4};
+    ZdfBank_ProcessT<zdfLadderK>(bank, in, out, cutoff, len);
 }
 
 /*
@@ -142,13 +998,9 @@ void Filter_Calculate(float c, float reso, struct filterCoeffT *const filterC)
         omega = c;
     }
 
-    /*
-     * use lookup here to get quicker results
-     */
-    cosOmega = sine[WAVEFORM_I((uint32_t)((float)((1ULL << 31) - 1) * omega + (float)((1ULL << 30) - 1)))];
-    sinOmega = sine[WAVEFORM_I((uint32_t)((float)((1ULL << 31) - 1) * omega))];
+    ml_sincos_pi(omega, &sinOmega, &cosOmega);
 
-    alpha = sinOmega / (2.0 * Q);
+    alpha = sinOmega / (2.0f * Q);
     b[0] = (1 - cosOmega) / 2;
     b[1] = 1 - cosOmega;
     b[2] = b[0];
@@ -195,10 +1047,7 @@ void Filter_CalculateNotch(float c, float reso __attribute__((unused)), struct f
 
     float r;
 
-    /*
-     * use lookup here to get quicker results
-     */
-    cosOmega = sine[WAVEFORM_I((uint32_t)((float)((1ULL << 31) - 1) * omega + (float)((1ULL << 30) - 1)))];
+    cosOmega = ml_cos_pi(omega);
     b[0] = 1;
     b[1] = -2 * cosOmega;
     b[2] = 1;
@@ -223,8 +1072,8 @@ float Filter_AmplitudeFilterResponse(float c, struct filterCoeffT *const filterC
     float *b = filterC->bNorm;
 
     float omega = c;
-    float cosOmega = sine[WAVEFORM_I((uint32_t)((float)((1ULL << 31) - 1) * omega + (float)((1ULL << 30) - 1)))];
-    float cos2Omega = sine[WAVEFORM_I((uint32_t)((float)((1ULL << 31) - 1) * 2 * omega + (float)((1ULL << 30) - 1)))];
+    float cosOmega = ml_cos_pi(omega);
+    float cos2Omega = ml_cos_pi(2 * omega);
 
     return sqrt((a[0] * a[0]) *
 
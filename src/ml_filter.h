@@ -55,6 +55,7 @@
 #include <stdint.h>
 #endif
 #include <ml_types.h>
+#include <ml_simd.h>
 
 
 struct filterCoeffT
@@ -95,6 +96,102 @@ struct filterQProcT
     Q1_14 w[3];
 };
 
+/*
+ * fixed point biquad with open source, the Q1_14 variants above are only available precompiled
+ * - coefficients are Q2_14 (1.0 is 0x4000), converted from the float coefficients
+ * - direct form 1 with a 32 bit accumulator, the output is saturated to the Q1_14 range
+ * - optionally the truncation error is fed back into the next sample (first order noise shaping),
+ *   this removes the error at low frequencies where the poles would amplify it
+ */
+#define FILTER_FIX_SHIFT    14
+
+struct filterFixCoeffT
+{
+    int16_t b[3];
+    int16_t a[2];
+};
+
+struct filterFixProcT
+{
+    const struct filterFixCoeffT *filterCoeff;
+    int16_t x1;
+    int16_t x2;
+    int16_t y1;
+    int16_t y2;
+    int32_t err;
+    bool noiseShaping;
+};
+
+/*
+ * filter bank, biquads of many voices stored as structure of arrays
+ * - FILTER_BANK_LANES voices are calculated in lockstep by the vector unit
+ * - without vector unit the voices are calculated one after another using the same layout
+ */
+#define FILTER_BANK_LANES   ML_SIMD_LANES
+
+#ifndef FILTER_BANK_VOICES
+#define FILTER_BANK_VOICES  64
+#endif
+
+#define FILTER_BANK_GROUPS  ((FILTER_BANK_VOICES + FILTER_BANK_LANES - 1) / FILTER_BANK_LANES)
+
+struct filterLaneT
+{
+    float b0[FILTER_BANK_LANES];
+    float b1[FILTER_BANK_LANES];
+    float b2[FILTER_BANK_LANES];
+    float a1[FILTER_BANK_LANES];
+    float a2[FILTER_BANK_LANES];
+    float w0[FILTER_BANK_LANES];
+    float w1[FILTER_BANK_LANES];
+};
+
+struct filterBankT
+{
+    struct filterLaneT lane[FILTER_BANK_GROUPS];
+};
+
+/*
+ * cache of Filter_Calculate results
+ * - cutoff (0 .. 1) and resonance (resoMin .. resoMax) are quantized into a grid
+ * - an entry is calculated the first time it is used
+ * - memory usage is FILTER_CACHE_CUTOFF_STEPS * FILTER_CACHE_RESO_STEPS * 20 bytes
+ */
+#ifndef FILTER_CACHE_CUTOFF_STEPS
+#define FILTER_CACHE_CUTOFF_STEPS   128
+#endif
+#ifndef FILTER_CACHE_RESO_STEPS
+#define FILTER_CACHE_RESO_STEPS     8
+#endif
+
+struct filterCacheT
+{
+    struct filterCoeffT coeff[FILTER_CACHE_RESO_STEPS][FILTER_CACHE_CUTOFF_STEPS];
+    uint32_t valid[FILTER_CACHE_RESO_STEPS][(FILTER_CACHE_CUTOFF_STEPS + 31) / 32];
+    float resoMin;
+    float resoScale;
+};
+
+/*
+ * zero delay feedback filters (topology preserving transform) in the filter bank layout
+ * - the cutoff is the normalized frequency fc / fs, it can be modulated per sample without zipper noise
+ * - the state variable filter calculates low pass, band pass and high pass in one pass
+ * - the 4 pole ladder calculates 24 dB and 12 dB low pass and a 24 dB high pass in one pass
+ * - a bank is either used as state variable filter or as ladder
+ */
+#define FILTER_ZDF_CUTOFF_MAX   0.49f
+
+struct zdfLaneT
+{
+    float cutoff[FILTER_BANK_LANES];
+    float k[FILTER_BANK_LANES]; /* damping (svf) or feedback (ladder) */
+    float s[4][FILTER_BANK_LANES];
+};
+
+struct zdfBankT
+{
+    struct zdfLaneT lane[FILTER_BANK_GROUPS];
+};
 
 void Filter_Init(struct filterProcT *const filterP, struct filterCoeffT *const filterC);
 void Filter_Proc_Init(struct filterProcT *const filterP);
@@ -105,6 +202,28 @@ void Filter_Process_Buffer(float *const signal, struct filterProcT *const filter
 void Filter_Calculate(float c, float reso, struct filterCoeffT *const  filterC);
 void Filter_CalculateNotch(float c, float reso, struct filterCoeffT *const filterC);
 
+void Filter_Cache_Init(struct filterCacheT *cache, float resoMin, float resoMax);
+const struct filterCoeffT *Filter_Cache_Get(struct filterCacheT *cache, float c, float reso);
+void Filter_Process_BufferRamp(float *const signal, struct filterProcT *const filterP, const struct filterCoeffT *target, uint32_t len);
+
+void FilterFix_Init(struct filterFixProcT *const filterP, const struct filterFixCoeffT *filterC, bool noiseShaping);
+void FilterFix_Reset(struct filterFixProcT *const filterP);
+void FilterFix_SetCoeff(struct filterFixCoeffT *const filterC, const struct filterCoeffT *src);
+void FilterFix_Process_Buffer(Q1_14 *const signal, struct filterFixProcT *const filterP, uint32_t len);
+
+void FilterBank_Init(struct filterBankT *bank);
+void FilterBank_SetCoeff(struct filterBankT *bank, uint32_t voice, const struct filterCoeffT *filterC);
+void FilterBank_Reset(struct filterBankT *bank, uint32_t voice);
+void FilterBank_ProcessGroup(struct filterBankT *bank, uint32_t group, float *signal, uint32_t len);
+void FilterBank_Process(struct filterBankT *bank, float *const *signal, uint32_t len);
+
+void ZdfBank_Init(struct zdfBankT *bank);
+void ZdfBank_Reset(struct zdfBankT *bank, uint32_t voice);
+void ZdfBank_SetSvf(struct zdfBankT *bank, uint32_t voice, float cutoff, float q);
+void ZdfBank_SetLadder(struct zdfBankT *bank, uint32_t voice, float cutoff, float reso);
+void ZdfBank_ProcessSvf(struct zdfBankT *bank, const float *const *in, float *const *lp, float *const *bp, float *const *hp, const float *const *cutoff, uint32_t len);
+void ZdfBank_ProcessLadder(struct zdfBankT *bank, const float *const *in, float *const *lp4, float *const *lp2, float *const *hp4, const float *const *cutoff, uint32_t len);
+
 
 void Filter_Init(struct filterQProcT *const filterP, struct filterQCoeffT *const filterC);
 void Filter_Proc_Init(struct filterQProcT *const filterP);
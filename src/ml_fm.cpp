@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_fm.cpp
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains the implementation of the phase modulation (FM) operator engine
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#include "ml_fm.h"
+#include "ml_lut.h"
+#include "ml_waveform.h"
+
+
+/*
+ * an operator output of 1.0 shifts the phase of the modulated operator by two periods,
+ * the offset is converted with 22 bit resolution which is still finer than the table
+ */
+#define FM_MOD_SHIFT    10
+#define FM_MOD_SCALE    (2.0f * (float)(1UL << (32 - FM_MOD_SHIFT)))
+
+/* largest float below 2^32, the phase increment of an operator is limited to it before the conversion */
+#define FM_ADD_VAL_MAX  4294967040.0f
+
+/* destination mask of an operator, bit n: modulates operator n, FM_OUT: carrier */
+#define FM_OUT  0x80
+
+struct fmAlgoT
+{
+    uint8_t ops;
+    uint8_t dest[ML_FM_OPS];
+};
+
+static constexpr struct fmAlgoT fmAlgo[FM_ALGO_CNT] =
+{
+    /* FM_ALGO_4OP_STACK */ {4, {FM_OUT, 0x01, 0x02, 0x04, 0, 0}},
+    /* FM_ALGO_4OP_Y */ {4, {FM_OUT, 0x01, 0x02, 0x02, 0, 0}},
+    /* FM_ALGO_4OP_BRANCH */ {4, {FM_OUT, 0x01, 0x02, 0x01, 0, 0}},
+    /* FM_ALGO_4OP_BRANCH2 */ {4, {FM_OUT, 0x01, 0x01, 0x04, 0, 0}},
+    /* FM_ALGO_4OP_TWO_PAIRS */ {4, {FM_OUT, 0x01, FM_OUT, 0x04, 0, 0}},
+    /* FM_ALGO_4OP_ONE_TO_3 */ {4, {FM_OUT, FM_OUT, FM_OUT, 0x07, 0, 0}},
+    /* FM_ALGO_4OP_PAIR_2 */ {4, {FM_OUT, FM_OUT, FM_OUT, 0x04, 0, 0}},
+    /* FM_ALGO_4OP_ADDITIVE */ {4, {FM_OUT, FM_OUT, FM_OUT, FM_OUT, 0, 0}},
+    /* FM_ALGO_6OP_STACK */ {6, {FM_OUT, 0x01, 0x02, 0x04, 0x08, 0x10}},
+    /* FM_ALGO_6OP_TWO_STACKS */ {6, {FM_OUT, 0x01, FM_OUT, 0x04, 0x08, 0x10}},
+    /* FM_ALGO_6OP_TWO_TRIPLES */ {6, {FM_OUT, 0x01, 0x02, FM_OUT, 0x08, 0x10}},
+    /* FM_ALGO_6OP_THREE_PAIRS */ {6, {FM_OUT, 0x01, FM_OUT, 0x04, FM_OUT, 0x10}},
+    /* FM_ALGO_6OP_ONE_TO_3 */ {6, {FM_OUT, FM_OUT, FM_OUT, 0x07, 0x08, 0x10}},
+    /* FM_ALGO_6OP_THREE_TO_1 */ {6, {FM_OUT, 0x01, 0x01, 0x04, 0x01, 0x10}},
+    /* FM_ALGO_6OP_PAIR_4 */ {6, {FM_OUT, FM_OUT, FM_OUT, FM_OUT, FM_OUT, 0x10}},
+    /* FM_ALGO_6OP_ADDITIVE */ {6, {FM_OUT, FM_OUT, FM_OUT, FM_OUT, FM_OUT, FM_OUT}},
+};
+
+static const float *const fmSine = mlLutSine.v;
+
+/*
+ * state of a voice during rendering, all indices are constant after inlining
+ * so the compiler can keep the members in registers
+ */
+struct fmStateT
+{
+    uint32_t phase[ML_FM_OPS];
+    uint32_t addVal[ML_FM_OPS];
+    float level[ML_FM_OPS];
+    float levelStep[ML_FM_OPS];
+    float feedback[ML_FM_OPS];
+    float fb0[ML_FM_OPS];
+    float fb1[ML_FM_OPS];
+    float mod[ML_FM_OPS];
+};
+
+template<uint8_t MASK, int J>
+struct FmRoute
+{
+    static inline void Add(float *mod, float y)
+    {
+        if (MASK & (1U << J))
+        {
+            mod[J] += y;
+        }
+        FmRoute < MASK, J - 1 >::Add(mod, y);
+    }
+};
+
+template<uint8_t MASK>
+struct FmRoute<MASK, -1>
+{
+    static inline void Add(float *, float) {}
+};
+
+template<uint32_t ALG, int OP>
+struct FmOp
+{
+    static inline void Calc(struct fmStateT &s, float &out)
+    {
+        static_assert(((fmAlgo[ALG].dest[OP] & ~FM_OUT) >> OP) == 0, "an operator can only modulate operators with a lower number");
+
+        /* feedback uses the mean of the last two outputs to avoid oscillation */
+        const float m = s.mod[OP] + s.feedback[OP] * (s.fb0[OP] + s.fb1[OP]);
+
+        s.phase[OP] += s.addVal[OP];
+        const uint32_t pos = s.phase[OP] + ((uint32_t)(int32_t)(m * FM_MOD_SCALE) << FM_MOD_SHIFT);
+        const float y = fmSine[WAVEFORM_I(pos)] * s.level[OP];
+        s.level[OP] += s.levelStep[OP];
+        s.fb1[OP] = s.fb0[OP];
+        s.fb0[OP] = y;
+
+        FmRoute < fmAlgo[ALG].dest[OP] & ~FM_OUT, OP - 1 >::Add(s.mod, y);
+        if (fmAlgo[ALG].dest[OP] & FM_OUT)
+        {
+            out += y;
+        }
+
+        FmOp < ALG, OP - 1 >::Calc(s, out);
+    }
+};
+
+template<uint32_t ALG>
+struct FmOp<ALG, -1>
+{
+    static inline void Calc(struct fmStateT &, float &) {}
+};
+
+template<uint32_t ALG>
+static void FmVoiceRender(struct fmVoiceT *voice, float *left, float *right, uint32_t len)
+{
+    const uint32_t ops = fmAlgo[ALG].ops;
+    struct fmStateT s;
+
+    for (uint32_t op = 0; op < ops; op++)
+    {
+        s.phase[op] = voice->phase[op];
+        s.addVal[op] = voice->addVal[op];
+        s.level[op] = voice->level[op];
+        s.levelStep[op] = (voice->levelTarget[op] - voice->level[op]) / ((float)len);
+        /* 1.0 shifts by half a period at full output */
+        s.feedback[op] = voice->patch->feedback[op] * 0.125f;
+        s.fb0[op] = voice->fb[op][0];
+        s.fb1[op] = voice->fb[op][1];
+    }
+
+    const float gainL = voice->gainL;
+    const float gainR = voice->gainR;
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        for (uint32_t op = 0; op < ops; op++)
+        {
+            s.mod[op] = 0.0f;
+        }
+
+        float out = 0.0f;
+        FmOp < ALG, fmAlgo[ALG].ops - 1 >::Calc(s, out);
+
+        left[n] += out * gainL;
+        right[n] += out * gainR;
+    }
+
+    for (uint32_t op = 0; op < ops; op++)
+    {
+        voice->phase[op] = s.phase[op];
+        /* remove the rounding error of the steps */
+        voice->level[op] = voice->levelTarget[op];
+        voice->fb[op][0] = s.fb0[op];
+        voice->fb[op][1] = s.fb1[op];
+    }
+}
+
+static void (*const fmRender[FM_ALGO_CNT])(struct fmVoiceT *voice, float *left, float *right, uint32_t len) =
+{
+    FmVoiceRender<0>, FmVoiceRender<1>, FmVoiceRender<2>, FmVoiceRender<3>,
+    FmVoiceRender<4>, FmVoiceRender<5>, FmVoiceRender<6>, FmVoiceRender<7>,
+    FmVoiceRender<8>, FmVoiceRender<9>, FmVoiceRender<10>, FmVoiceRender<11>,
+    FmVoiceRender<12>, FmVoiceRender<13>, FmVoiceRender<14>, FmVoiceRender<15>,
+};
+
+void FmVoice_Init(struct fmVoiceT *voice)
+{
+    voice->patch = NULL;
+    for (uint32_t op = 0; op < ML_FM_OPS; op++)
+    {
+        voice->phase[op] = 0;
+        voice->addVal[op] = 0;
+        voice->level[op] = 0.0f;
+        voice->levelTarget[op] = 0.0f;
+        voice->fb[op][0] = 0.0f;
+        voice->fb[op][1] = 0.0f;
+    }
+    voice->gainL = 1.0f;
+    voice->gainR = 1.0f;
+    voice->active = false;
+}
+
+/*
+ * the levels start at zero, they should be set by the envelopes before each block
+ */
+void FmVoice_NoteOn(struct fmVoiceT *voice, const struct fmPatchT *patch, uint32_t addVal)
+{
+    voice->patch = patch;
+    for (uint32_t op = 0; op < ML_FM_OPS; op++)
+    {
+        voice->phase[op] = 0;
+        voice->level[op] = 0.0f;
+        voice->levelTarget[op] = 0.0f;
+        voice->fb[op][0] = 0.0f;
+        voice->fb[op][1] = 0.0f;
+    }
+    FmVoice_SetPitch(voice, addVal);
+    voice->active = true;
+}
+
+/*
+ * has no effect before FmVoice_NoteOn, the ratios come from the patch
+ */
+void FmVoice_SetPitch(struct fmVoiceT *voice, uint32_t addVal)
+{
+    if (voice->patch == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t op = 0; op < ML_FM_OPS; op++)
+    {
+        /* high notes with large ratios exceed the range of uint32_t */
+        float add = ((float)addVal) * voice->patch->ratio[op] * voice->patch->detune[op];
+        add = (add > FM_ADD_VAL_MAX) ? FM_ADD_VAL_MAX : add;
+        add = (add < 0.0f) ? 0.0f : add;
+        voice->addVal[op] = (uint32_t)add;
+    }
+}
+
+/*
+ * the level is reached at the end of the next block
+ */
+void FmVoice_SetLevel(struct fmVoiceT *voice, uint32_t op, float level)
+{
+    if (op < ML_FM_OPS)
+    {
+        voice->levelTarget[op] = level;
+    }
+}
+
+void FmVoice_SetGain(struct fmVoiceT *voice, float gainL, float gainR)
+{
+    voice->gainL = gainL;
+    voice->gainR = gainR;
+}
+
+void FmVoice_Stop(struct fmVoiceT *voice)
+{
+    voice->active = false;
+}
+
+void FmVoice_Process(struct fmVoiceT *voice, int cnt, float *left, float *right, uint32_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < cnt; i++)
+    {
+        if (voice[i].active && (voice[i].patch->algo < FM_ALGO_CNT))
+        {
+            fmRender[voice[i].patch->algo](&voice[i], left, right, len);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_fm.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains a phase modulation (FM) operator engine.
+ *
+ * A voice has up to ML_FM_OPS operators. Each operator is a sine oscillator
+ * with an integer phase accumulator reading the shared sine table (mlLutSine).
+ * The algorithm defines which operator modulates which other operator and
+ * which operators are sent to the output.
+ *
+ * Operators are numbered from 0. An operator can only modulate operators with a
+ * lower number, so operators are calculated from the highest to the lowest.
+ * Every operator has its own feedback.
+ *
+ * The kernel is created for each algorithm at compile time, the routing
+ * does not cost anything during runtime and the state of a voice stays in registers.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_FM_H_
+#define SRC_ML_FM_H_
+
+
+#include <Arduino.h>
+
+
+#define ML_FM_OPS   6 /* maximum number of operators per voice */
+
+/*
+ * available algorithms, "a>b" means a modulates b, "out" lists the carriers
+ */
+#define FM_ALGO_4OP_STACK       0 /* 3>2>1>0, out 0 */
+#define FM_ALGO_4OP_Y           1 /* 3>1, 2>1, 1>0, out 0 */
+#define FM_ALGO_4OP_BRANCH      2 /* 3>0, 2>1>0, out 0 */
+#define FM_ALGO_4OP_BRANCH2     3 /* 3>2>0, 1>0, out 0 */
+#define FM_ALGO_4OP_TWO_PAIRS   4 /* 3>2, 1>0, out 0 2 */
+#define FM_ALGO_4OP_ONE_TO_3    5 /* 3>2, 3>1, 3>0, out 0 1 2 */
+#define FM_ALGO_4OP_PAIR_2      6 /* 3>2, out 0 1 2 */
+#define FM_ALGO_4OP_ADDITIVE    7 /* out 0 1 2 3 */
+#define FM_ALGO_6OP_STACK       8 /* 5>4>3>2>1>0, out 0 */
+#define FM_ALGO_6OP_TWO_STACKS  9 /* 5>4>3>2, 1>0, out 0 2 */
+#define FM_ALGO_6OP_TWO_TRIPLES 10 /* 5>4>3, 2>1>0, out 0 3 */
+#define FM_ALGO_6OP_THREE_PAIRS 11 /* 5>4, 3>2, 1>0, out 0 2 4 */
+#define FM_ALGO_6OP_ONE_TO_3    12 /* 5>4>3, 3>2, 3>1, 3>0, out 0 1 2 */
+#define FM_ALGO_6OP_THREE_TO_1  13 /* 5>4>0, 3>2>0, 1>0, out 0 */
+#define FM_ALGO_6OP_PAIR_4      14 /* 5>4, out 0 1 2 3 4 */
+#define FM_ALGO_6OP_ADDITIVE    15 /* out 0 1 2 3 4 5 */
+#define FM_ALGO_CNT             16
+
+struct fmPatchT
+{
+    uint8_t algo; /* FM_ALGO_... */
+    float ratio[ML_FM_OPS]; /* frequency of the operator relative to the note */
+    float detune[ML_FM_OPS]; /* additional multiplier, 1.0f without detune */
+    float feedback[ML_FM_OPS]; /* self modulation of the operator, 0 .. 1 */
+};
+
+struct fmVoiceT
+{
+    const struct fmPatchT *patch;
+    uint32_t phase[ML_FM_OPS];
+    uint32_t addVal[ML_FM_OPS];
+    float level[ML_FM_OPS]; /* current output level of the operator */
+    float levelTarget[ML_FM_OPS]; /* reached at the end of the next block */
+    float fb[ML_FM_OPS][2]; /* last two outputs, used for the feedback */
+    float gainL;
+    float gainR;
+    bool active;
+};
+
+
+void FmVoice_Init(struct fmVoiceT *voice);
+void FmVoice_NoteOn(struct fmVoiceT *voice, const struct fmPatchT *patch, uint32_t addVal);
+void FmVoice_SetPitch(struct fmVoiceT *voice, uint32_t addVal);
+void FmVoice_SetLevel(struct fmVoiceT *voice, uint32_t op, float level);
+void FmVoice_SetGain(struct fmVoiceT *voice, float gainL, float gainR);
+void FmVoice_Stop(struct fmVoiceT *voice);
+void FmVoice_Process(struct fmVoiceT *voice, int cnt, float *left, float *right, uint32_t len);
+
+
+#endif /* SRC_ML_FM_H_ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_lut.cpp
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains the lookup tables calculated by the compiler
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#include <ml_lut.h>
+
+
+/* the ESP8266 can only read 32 bit values from flash, 16 bit tables stay in RAM */
+#ifdef ESP8266
+#define PROGMEM_16
+#else
+#define PROGMEM_16  PROGMEM
+#endif
+
+
+constexpr MlLutT<WAVEFORM_CNT> mlLutSine PROGMEM = MlLut_SineGen<WAVEFORM_CNT>(MlLutMakeSeq<WAVEFORM_CNT>::type());
+constexpr MlLutT<WAVEFORM_CNT> mlLutSaw PROGMEM = MlLut_SawGen<WAVEFORM_CNT>(MlLutMakeSeq<WAVEFORM_CNT>::type());
+constexpr MlLutT<2048> mlLutSine2048 PROGMEM = MlLut_SineGen<2048>(MlLutMakeSeq<2048>::type());
+constexpr MlLutQT<WAVEFORM_CNT> mlLutSineQ PROGMEM_16 = MlLut_SineGenQ<WAVEFORM_CNT>(MlLutMakeSeq<WAVEFORM_CNT>::type());
+constexpr MlLutQT<WAVEFORM_CNT> mlLutSawQ PROGMEM_16 = MlLut_SawGenQ<WAVEFORM_CNT>(MlLutMakeSeq<WAVEFORM_CNT>::type());
+constexpr MlLutT<ML_LUT_PAN_CNT + 1> mlLutPan PROGMEM = MlLut_QuarterSineGen<ML_LUT_PAN_CNT>(MlLutMakeSeq<ML_LUT_PAN_CNT + 1>::type());
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_lut.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains lookup tables which are calculated by the compiler.
+ * They are placed in flash (PROGMEM on ESP8266, .rodata elsewhere) and do not need
+ * any RAM or time during boot.
+ *
+ * The generator only uses C++11 constexpr functions to support all toolchains.
+ * The float tables have 4 byte alignment. The ESP8266 can read them directly from
+ * flash because it only faults on 8 and 16 bit accesses, the fixed point tables stay in RAM there.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_LUT_H_
+#define SRC_ML_LUT_H_
+
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <ml_waveform.h>
+
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+
+template<uint32_t CNT> struct MlLutT
+{
+    float v[CNT];
+};
+
+template<uint32_t CNT> struct MlLutQT
+{
+    int16_t v[CNT]; /* Q1_14 */
+};
+
+
+extern const MlLutT<WAVEFORM_CNT> mlLutSine; /* one period of sine */
+extern const MlLutT<WAVEFORM_CNT> mlLutSaw; /* one period of a rising saw, -1 .. 1 */
+extern const MlLutT<2048> mlLutSine2048; /* one period of sine with higher resolution */
+extern const MlLutQT<WAVEFORM_CNT> mlLutSineQ; /* fixed point version of mlLutSine */
+extern const MlLutQT<WAVEFORM_CNT> mlLutSawQ; /* fixed point version of mlLutSaw */
+
+/*
+ * constant power pan law, entry i is sin(pi/2 * i / ML_LUT_PAN_CNT)
+ * the right gain is read at the pan position, the left one mirrored
+ */
+#define ML_LUT_PAN_CNT  128
+extern const MlLutT<ML_LUT_PAN_CNT + 1> mlLutPan;
+
+/* gains of the pan law, pan from -1 (left) to 1 (right) */
+static inline void MlLut_PanGain(float pan, float *panL, float *panR)
+{
+    pan = (pan < -1.0f) ? -1.0f : pan;
+    pan = (pan > 1.0f) ? 1.0f : pan;
+
+    const float pos = (pan + 1.0f) * (0.5f * ML_LUT_PAN_CNT);
+    uint32_t idx = (uint32_t)pos;
+    idx = (idx >= ML_LUT_PAN_CNT) ? (ML_LUT_PAN_CNT - 1) : idx;
+    const float frac = pos - (float)idx;
+
+    *panR = mlLutPan.v[idx] + (mlLutPan.v[idx + 1] - mlLutPan.v[idx]) * frac;
+    *panL = mlLutPan.v[ML_LUT_PAN_CNT - idx] + (mlLutPan.v[ML_LUT_PAN_CNT - idx - 1] - mlLutPan.v[ML_LUT_PAN_CNT - idx]) * frac;
+}
+
+
+/*
+ * compile time helpers to create the tables
+ */
+template<uint32_t... I> struct MlLutSeq {};
+
+template<class A, class B> struct MlLutCat;
+
+template<uint32_t... A, uint32_t... B> struct MlLutCat<MlLutSeq<A...>, MlLutSeq<B...>>
+{
+    typedef MlLutSeq < A..., (sizeof...(A) + B)... > type;
+};
+
+/* creates the sequence 0 .. N-1, the template depth is only log2(N) */
+template<uint32_t N> struct MlLutMakeSeq
+{
+    typedef typename MlLutCat < typename MlLutMakeSeq < N / 2 >::type, typename MlLutMakeSeq < N - N / 2 >::type >::type type;
+};
+
+template<> struct MlLutMakeSeq<0>
+{
+    typedef MlLutSeq<> type;
+};
+
+template<> struct MlLutMakeSeq<1>
+{
+    typedef MlLutSeq<0> type;
+};
+
+/* taylor series of sin(x), error below 1e-11 for x = 0 .. pi/2 */
+constexpr double MlLut_SinQ(double x, double x2)
+{
+    return x * (1.0 - x2 / 6.0 * (1.0 - x2 / 20.0 * (1.0 - x2 / 42.0 * (1.0 - x2 / 72.0 * (1.0 - x2 / 110.0 * (1.0 - x2 / 156.0 * (1.0 - x2 / 210.0 * (1.0 - x2 / 272.0))))))));
+}
+
+constexpr double MlLut_SinQuarter(uint32_t r, uint32_t cnt)
+{
+    return MlLut_SinQ(r * 1.5707963267948966 / cnt, (r * 1.5707963267948966 / cnt) * (r * 1.5707963267948966 / cnt));
+}
+
+/* sin(2 * pi * i / cnt), the symmetry of the quarters is used to keep the series short */
+constexpr double MlLut_Sin(uint32_t i, uint32_t cnt)
+{
+    return ((i * 4) / cnt == 0) ? MlLut_SinQuarter(i * 4, cnt) :
+           ((i * 4) / cnt == 1) ? MlLut_SinQuarter(2 * cnt - i * 4, cnt) :
+           ((i * 4) / cnt == 2) ? -MlLut_SinQuarter(i * 4 - 2 * cnt, cnt) :
+           -MlLut_SinQuarter(4 * cnt - i * 4, cnt);
+}
+
+template<uint32_t CNT, uint32_t... I>
+constexpr MlLutT<CNT> MlLut_SineGen(MlLutSeq<I...>)
+{
+    return MlLutT<CNT> {{ (float)MlLut_Sin(I, CNT)... }};
+}
+
+template<uint32_t CNT, uint32_t... I>
+constexpr MlLutT<CNT> MlLut_SawGen(MlLutSeq<I...>)
+{
+    return MlLutT<CNT> {{ (2.0f * ((float)I) / ((float)CNT) - 1.0f)... }};
+}
+
+template<uint32_t CNT, uint32_t... I>
+constexpr MlLutT<sizeof...(I)> MlLut_QuarterSineGen(MlLutSeq<I...>)
+{
+    return MlLutT<sizeof...(I)> {{ (float)MlLut_Sin(I, 4 * CNT)... }};
+}
+
+/* rounds to Q1_14, 1.0 is 0x4000 */
+constexpr int16_t MlLut_Q14(double x)
+{
+    return (int16_t)((x >= 0.0) ? (x * 16384.0 + 0.5) : (x * 16384.0 - 0.5));
+}
+
+template<uint32_t CNT, uint32_t... I>
+constexpr MlLutQT<CNT> MlLut_SineGenQ(MlLutSeq<I...>)
+{
+    return MlLutQT<CNT> {{ MlLut_Q14(MlLut_Sin(I, CNT))... }};
+}
+
+template<uint32_t CNT, uint32_t... I>
+constexpr MlLutQT<CNT> MlLut_SawGenQ(MlLutSeq<I...>)
+{
+    return MlLutQT<CNT> {{ MlLut_Q14(2.0 * ((double)I) / ((double)CNT) - 1.0)... }};
+}
+
+
+#endif /* SRC_ML_LUT_H_ */
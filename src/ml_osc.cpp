@@ -41,58 +41,1018 @@
 
 
 #include "ml_osc.h"
+#include "ml_lut.h"
 #include "ml_waveform.h"
 
 
-static void OscProcessSingle(oscillatorT *osc, uint32_t len);
+/*
+ * the morph waveform shifts the phase, one unit of the morph value is 64 * 89478480 / 2^32 periods
+ * the offset is calculated in steps of 1/65536 of a period to stay within the int32 range
+ */
+#define OSC_MORPH_SHIFT 16
+#define OSC_MORPH_SCALE (((float)89478480) * 64.0f / ((float)(1UL << OSC_MORPH_SHIFT)))
+
 
+/* frame position of OSC_GENERATOR_MORPH_TABLE, the upper limit keeps the second frame within the table */
+#define OSC_MORPH_FRAME_MAX ((float)(OSC_MORPH_FRAMES - 1) * 0.99999f)
 
-/* will be removed in future */
-extern float sine[WAVEFORM_CNT];
-extern float saw[WAVEFORM_CNT];
 
-static void OscProcessSingle(oscillatorT *osc, uint32_t len)
+/* unused lanes point to this, their phase and increment stay zero */
+static const float oscSilence[1] = {0.0f};
+
+
+static uint32_t OscMipMapLevel(uint32_t addVal)
 {
-    for (uint32_t n = 0U; n < len; n++)
+    /* use the first level which has no harmonic above nyquist */
+    uint32_t level = 0;
+    while ((level < OSC_MIPMAP_LEVELS - 1) && (addVal > (1UL << (32 - WAVEFORM_BIT + level))))
     {
-        osc->samplePos += (uint32_t)((*osc->cfg->pitchMultiplier) * ((float)osc->addVal) * osc->cfg->pitchOctave * osc->cfg->pitch * *osc->pitchMod);
-        uint32_t samplePos = osc->samplePos;
-#if 1
-        float morphMod = /*(*osc->cfg->morph) * */ osc->cfg->morphWaveForm[WAVEFORM_I(osc->samplePos)];
-        morphMod *= ((float)89478480);
-        morphMod *= (*osc->cfg->morph) * 64;
-        samplePos += morphMod;
+        level++;
+    }
+    return level;
+}
 
-#endif
-        float sig = osc->cfg->selectedWaveForm[WAVEFORM_I(samplePos)];
-#if 0
-        float sig = 0;
-        if (saw == NULL)
+/*
+ * reads the modulation sources of a voice (control rate)
+ * a changed pitch or morph value is not applied immediately but ramped within rampLen samples
+ */
+static void OscLaneLoad(struct oscLaneT *lane, uint32_t l, const struct synth_osc_cfg_s *cfg, uint32_t addVal, float pitchMod, uint32_t rampLen)
+{
+    const uint32_t addValTarget = (uint32_t)((*cfg->pitchMultiplier) * ((float)addVal) * cfg->pitchOctave * cfg->pitch * pitchMod);
+    /* without a morph table the voice falls back to selectedWaveForm */
+    const uint8_t generator = ((cfg->generator == OSC_GENERATOR_MORPH_TABLE) && (cfg->morphTable == NULL)) ? OSC_GENERATOR_TABLE : cfg->generator;
+    float morphTarget;
+    if (generator == OSC_GENERATOR_MORPH_TABLE)
+    {
+        morphTarget = (*cfg->morph) * (OSC_MORPH_FRAMES - 1);
+        morphTarget = (morphTarget < 0.0f) ? 0.0f : morphTarget;
+        morphTarget = (morphTarget > OSC_MORPH_FRAME_MAX) ? OSC_MORPH_FRAME_MAX : morphTarget;
+    }
+    else
+    {
+        morphTarget = (*cfg->morph) * OSC_MORPH_SCALE;
+    }
+
+    /* morph is a frame index for MORPH_TABLE and a phase offset otherwise, it cannot be ramped across a change */
+    const bool generatorChanged = (lane->generator[l] != generator);
+
+    if ((addValTarget != lane->addValTarget[l]) || (morphTarget != lane->morphTarget[l]) || generatorChanged)
+    {
+        lane->addValTarget[l] = addValTarget;
+        lane->morphTarget[l] = morphTarget;
+
+        /* a voice starting from zero does not glide in */
+        if ((rampLen <= 1) || (lane->addVal[l] == 0))
         {
-            Serial.printf("saw not ready!\n");
+            lane->addVal[l] = addValTarget;
+            lane->morph[l] = morphTarget;
+            lane->rampCnt[l] = 0;
         }
         else
         {
-            sig = sine[WAVEFORM_I(osc->samplePos)];
-            sig *= osc->cfg->volume;
+            lane->addValStep[l] = ((int32_t)(addValTarget - lane->addVal[l])) / (int32_t)rampLen;
+            lane->morphStep[l] = (morphTarget - lane->morph[l]) / ((float)rampLen);
+            lane->rampCnt[l] = rampLen;
+        }
+
+        if (generatorChanged)
+        {
+            lane->morph[l] = morphTarget;
+            lane->morphStep[l] = 0.0f;
         }
+    }
+
+    lane->volume[l] = cfg->volume;
+    lane->morphWaveForm[l] = cfg->morphWaveForm;
+    lane->generator[l] = generator;
+    lane->pulseWidth[l] = cfg->pulseWidth;
+
+    if (generator == OSC_GENERATOR_MORPH_TABLE)
+    {
+        lane->waveForm[l] = cfg->morphTable->data;
+        lane->waveBit[l] = 0;
+    }
+    else if (generator != OSC_GENERATOR_TABLE)
+    {
+        /* table is not used but the lane must not look like an unused one */
+        lane->waveForm[l] = cfg->selectedWaveForm;
+        lane->waveBit[l] = 0;
+    }
+    else if (cfg->selectedMipMap != NULL)
+    {
+        /* the highest pitch within the block selects the table */
+        const uint32_t maxAddVal = (addValTarget > lane->addVal[l]) ? addValTarget : lane->addVal[l];
+        const uint32_t level = OscMipMapLevel(maxAddVal);
+        lane->waveForm[l] = &cfg->selectedMipMap->data[OscMipMap_Offset(level)];
+        lane->waveBit[l] = OscMipMap_Bit(level);
+    }
+    else
+    {
+        lane->waveForm[l] = cfg->selectedWaveForm;
+        lane->waveBit[l] = 0;
+    }
+}
+
+static void OscLaneClear(struct oscLaneT *lane, uint32_t l)
+{
+    lane->samplePos[l] = 0;
+    lane->addVal[l] = 0;
+    lane->addValTarget[l] = 0;
+    lane->addValStep[l] = 0;
+    lane->volume[l] = 0.0f;
+    lane->morph[l] = 0.0f;
+    lane->morphTarget[l] = 0.0f;
+    lane->morphStep[l] = 0.0f;
+    lane->rampCnt[l] = 0;
+    lane->waveForm[l] = oscSilence;
+    lane->morphWaveForm[l] = oscSilence;
+    lane->waveBit[l] = 0;
+    lane->generator[l] = OSC_GENERATOR_TABLE;
+    lane->pulseWidth[l] = 0.5f;
+    lane->panL[l] = 1.0f;
+    lane->panR[l] = 1.0f;
+}
+
+template<bool interpolate>
+static inline float OscRead(const float *waveForm, uint32_t waveBit, uint32_t pos)
+{
+    if (interpolate)
+    {
+        const uint32_t idx = pos >> (32 - waveBit);
+        const float frac = ((float)((pos << waveBit) >> 8)) * (1.0f / 16777216.0f);
+        return waveForm[idx] + (waveForm[idx + 1] - waveForm[idx]) * frac;
+    }
+    else
+    {
+        return waveForm[WAVEFORM_I(pos)];
+    }
+}
+
+#if ML_SIMD
+template<bool interpolate>
+static inline ml_vf OscReadV(const float *waveForm, uint32_t waveBit, ml_vi pos)
+{
+    if (interpolate)
+    {
+        const ml_vi idx = ml_vi_srl(pos, 32 - waveBit);
+        const ml_vf frac = ml_vf_mul(ml_vi_to_vf(ml_vi_srl(ml_vi_sll(pos, waveBit), 8)), ml_vf_set1(1.0f / 16777216.0f));
+        const ml_vf a = ml_vf_gather1(waveForm, idx);
+        const ml_vf b = ml_vf_gather1(waveForm, ml_vi_add(idx, ml_vi_set1(1)));
+        return ml_vf_madd(a, ml_vf_sub(b, a), frac);
+    }
+    else
+    {
+        return ml_vf_gather1(waveForm, ml_vi_srl(pos, 32 - WAVEFORM_BIT));
+    }
+}
 #endif
-        sig *= osc->cfg->volume;
-
-#if 0
-        osc->dest[0][n] += osc->pan_l * sig;
-        osc->dest[1][n] += osc->pan_r * sig;
-#else
-        osc->dest[0][n] += sig;
-        osc->dest[1][n] += sig;
+
+/*
+ * renders a segment of a single voice,
+ * the phase increment grows by addValStep and the morph value by morphStep per sample (both are zero without ramp),
+ * the vector unit calculates ML_SIMD_LANES consecutive samples at once
+ */
+template<bool interpolate>
+static void OscVoiceSegment(struct oscLaneT *lane, uint32_t l, float *left, float *right, uint32_t len, int32_t addValStep, float morphStep)
+{
+    uint32_t samplePos = lane->samplePos[l];
+    uint32_t addVal = lane->addVal[l];
+    float morph = lane->morph[l];
+    /* panning is part of the volume, the stereo output needs no extra pass */
+    const float volumeL = lane->volume[l] * lane->panL[l];
+    const float volumeR = lane->volume[l] * lane->panR[l];
+    const float *waveForm = lane->waveForm[l];
+    const float *morphWaveForm = lane->morphWaveForm[l];
+    const uint32_t waveBit = lane->waveBit[l];
+
+    uint32_t n = 0U;
+
+#if ML_SIMD
+    const uint32_t lenV = len - (len % ML_SIMD_LANES);
+
+    if (lenV > 0)
+    {
+        /*
+         * sample k of a vector (k = 1 .. ML_SIMD_LANES) is at samplePos + k * addVal + addValStep * k * (k + 1) / 2
+         * the offsets grow by k * ML_SIMD_LANES * addValStep per vector
+         */
+        uint32_t offset[ML_SIMD_LANES];
+        uint32_t offsetStep[ML_SIMD_LANES];
+        float morphInit[ML_SIMD_LANES];
+        for (uint32_t k = 0; k < ML_SIMD_LANES; k++)
+        {
+            offset[k] = (k + 1) * addVal + (uint32_t)addValStep * (((k + 1) * (k + 2)) / 2);
+            offsetStep[k] = (k + 1) * ML_SIMD_LANES * (uint32_t)addValStep;
+            morphInit[k] = morph + morphStep * (k + 1);
+        }
+
+        ml_vi offsetV = ml_vi_load(offset);
+        const ml_vi offsetStepV = ml_vi_load(offsetStep);
+        ml_vf morphV = ml_vf_load(morphInit);
+        const ml_vf morphStepV = ml_vf_set1(morphStep * ML_SIMD_LANES);
+        const ml_vf volumeLV = ml_vf_set1(volumeL);
+        const ml_vf volumeRV = ml_vf_set1(volumeR);
+        const uint32_t quad = (uint32_t)addValStep * ((ML_SIMD_LANES * (ML_SIMD_LANES + 1)) / 2);
+
+        for (; n < lenV; n += ML_SIMD_LANES)
+        {
+            const ml_vi pos = ml_vi_add(ml_vi_set1((int32_t)samplePos), offsetV);
+
+            ml_vf morphMod = ml_vf_gather1(morphWaveForm, ml_vi_srl(pos, 32 - WAVEFORM_BIT));
+            ml_vi posMod = ml_vi_add(pos, ml_vi_sll(ml_vf_to_vi(ml_vf_mul(morphMod, morphV)), OSC_MORPH_SHIFT));
+
+            const ml_vf sig = OscReadV<interpolate>(waveForm, waveBit, posMod);
+
+            ml_vf_store(&left[n], ml_vf_madd(ml_vf_load(&left[n]), sig, volumeLV));
+            ml_vf_store(&right[n], ml_vf_madd(ml_vf_load(&right[n]), sig, volumeRV));
+
+            samplePos += ML_SIMD_LANES * addVal + quad;
+            addVal += ML_SIMD_LANES * (uint32_t)addValStep;
+            offsetV = ml_vi_add(offsetV, offsetStepV);
+            morphV = ml_vf_add(morphV, morphStepV);
+        }
+
+        morph += morphStep * lenV;
+    }
 #endif
+
+    for (; n < len; n++)
+    {
+        addVal += (uint32_t)addValStep;
+        morph += morphStep;
+        samplePos += addVal;
+
+        int32_t morphMod = (int32_t)(morphWaveForm[WAVEFORM_I(samplePos)] * morph);
+        uint32_t pos = samplePos + ((uint32_t)morphMod << OSC_MORPH_SHIFT);
+
+        const float sig = OscRead<interpolate>(waveForm, waveBit, pos);
+
+        left[n] += sig * volumeL;
+        right[n] += sig * volumeR;
     }
+
+    lane->samplePos[l] = samplePos;
+    lane->addVal[l] = addVal;
+    lane->morph[l] = morph;
 }
 
+/*
+ * renders a segment of a voice using precomputed morph frames,
+ * the frame position grows by morphStep per sample
+ */
+static void OscVoiceSegmentFrames(struct oscLaneT *lane, uint32_t l, float *left, float *right, uint32_t len, int32_t addValStep, float morphStep)
+{
+    uint32_t samplePos = lane->samplePos[l];
+    uint32_t addVal = lane->addVal[l];
+    float morph = lane->morph[l];
+    const float volumeL = lane->volume[l] * lane->panL[l];
+    const float volumeR = lane->volume[l] * lane->panR[l];
+    const float *frames = lane->waveForm[l];
+
+    uint32_t n = 0U;
+
+#if ML_SIMD
+    const uint32_t lenV = len - (len % ML_SIMD_LANES);
+
+    if (lenV > 0)
+    {
+        /* same closed form phase ramp as OscVoiceSegment */
+        uint32_t offset[ML_SIMD_LANES];
+        uint32_t offsetStep[ML_SIMD_LANES];
+        float morphInit[ML_SIMD_LANES];
+        for (uint32_t k = 0; k < ML_SIMD_LANES; k++)
+        {
+            offset[k] = (k + 1) * addVal + (uint32_t)addValStep * (((k + 1) * (k + 2)) / 2);
+            offsetStep[k] = (k + 1) * ML_SIMD_LANES * (uint32_t)addValStep;
+            morphInit[k] = morph + morphStep * (k + 1);
+        }
+
+        ml_vi offsetV = ml_vi_load(offset);
+        const ml_vi offsetStepV = ml_vi_load(offsetStep);
+        ml_vf morphV = ml_vf_load(morphInit);
+        const ml_vf morphStepV = ml_vf_set1(morphStep * ML_SIMD_LANES);
+        const ml_vf volumeLV = ml_vf_set1(volumeL);
+        const ml_vf volumeRV = ml_vf_set1(volumeR);
+        const ml_vi frameSizeV = ml_vi_set1(WAVEFORM_CNT);
+        const uint32_t quad = (uint32_t)addValStep * ((ML_SIMD_LANES * (ML_SIMD_LANES + 1)) / 2);
+
+        for (; n < lenV; n += ML_SIMD_LANES)
+        {
+            const ml_vi pos = ml_vi_add(ml_vi_set1((int32_t)samplePos), offsetV);
+            const ml_vi frame = ml_vf_to_vi(morphV);
+            const ml_vf frac = ml_vf_sub(morphV, ml_vi_to_vf(frame));
+
+            /* frame * WAVEFORM_CNT, the frame count is small */
+            const ml_vi idx = ml_vi_add(ml_vi_sll(frame, WAVEFORM_BIT), ml_vi_srl(pos, 32 - WAVEFORM_BIT));
+            const ml_vf a = ml_vf_gather1(frames, idx);
+            const ml_vf b = ml_vf_gather1(frames, ml_vi_add(idx, frameSizeV));
+            const ml_vf sig = ml_vf_madd(a, ml_vf_sub(b, a), frac);
+
+            ml_vf_store(&left[n], ml_vf_madd(ml_vf_load(&left[n]), sig, volumeLV));
+            ml_vf_store(&right[n], ml_vf_madd(ml_vf_load(&right[n]), sig, volumeRV));
+
+            samplePos += ML_SIMD_LANES * addVal + quad;
+            addVal += ML_SIMD_LANES * (uint32_t)addValStep;
+            offsetV = ml_vi_add(offsetV, offsetStepV);
+            morphV = ml_vf_add(morphV, morphStepV);
+        }
+
+        morph += morphStep * lenV;
+    }
+#endif
+
+    for (; n < len; n++)
+    {
+        addVal += (uint32_t)addValStep;
+        morph += morphStep;
+        samplePos += addVal;
+
+        const uint32_t frame = (uint32_t)morph;
+        const float frac = morph - (float)frame;
+        const float *a = &frames[frame * WAVEFORM_CNT + WAVEFORM_I(samplePos)];
+        const float sig = a[0] + (a[WAVEFORM_CNT] - a[0]) * frac;
+
+        left[n] += sig * volumeL;
+        right[n] += sig * volumeR;
+    }
+
+    lane->samplePos[l] = samplePos;
+    lane->addVal[l] = addVal;
+    lane->morph[l] = morph;
+}
+
+/*
+ * residual of a band limited step with the height 2, t is the phase, dt the phase increment per sample
+ * @see https://www.kvraudio.com/forum/viewtopic.php?t=375517
+ */
+static inline float OscPolyBlep(float t, float dt)
+{
+    if (t < dt)
+    {
+        const float x = t / dt;
+        return x + x - x * x - 1.0f;
+    }
+    else if (t > 1.0f - dt)
+    {
+        const float x = (t - 1.0f) / dt;
+        return x * x + x + x + 1.0f;
+    }
+    return 0.0f;
+}
+
+/*
+ * residual of a band limited corner where the slope increases by one per period
+ */
+static inline float OscPolyBlamp(float t, float dt)
+{
+    if (t < dt)
+    {
+        const float x = 1.0f - t / dt;
+        return dt * x * x * x * (1.0f / 6.0f);
+    }
+    else if (t > 1.0f - dt)
+    {
+        const float x = 1.0f + (t - 1.0f) / dt;
+        return dt * x * x * x * (1.0f / 6.0f);
+    }
+    return 0.0f;
+}
+
+static inline float OscWrap(float t)
+{
+    return (t >= 1.0f) ? (t - 1.0f) : t;
+}
+
+/*
+ * table free generators, the cost per sample does not depend on pitch or pulse width
+ */
+static void OscVoiceSegmentBlep(struct oscLaneT *lane, uint32_t l, float *left, float *right, uint32_t len, int32_t addValStep)
+{
+    const float phaseScale = 1.0f / 4294967296.0f;
+
+    uint32_t samplePos = lane->samplePos[l];
+    uint32_t addVal = lane->addVal[l];
+    const float volumeL = lane->volume[l] * lane->panL[l];
+    const float volumeR = lane->volume[l] * lane->panR[l];
+    float dt = ((float)addVal) * phaseScale;
+    const float dtStep = ((float)addValStep) * phaseScale;
+
+    /* both edges of the pulse must be at least one sample apart, above nyquist the pulse is square */
+    const float dtEnd = dt + dtStep * len;
+    float dtMax = (dtEnd > dt) ? dtEnd : dt;
+    dtMax = (dtMax > 0.5f) ? 0.5f : dtMax;
+    float pw = lane->pulseWidth[l];
+    pw = (pw < dtMax) ? dtMax : pw;
+    pw = (pw > 1.0f - dtMax) ? (1.0f - dtMax) : pw;
+
+    switch (lane->generator[l])
+    {
+    case OSC_GENERATOR_BLEP_SAW:
+        for (uint32_t n = 0U; n < len; n++)
+        {
+            addVal += (uint32_t)addValStep;
+            dt += dtStep;
+            samplePos += addVal;
+            const float t = ((float)samplePos) * phaseScale;
+            const float sig = t + t - 1.0f - OscPolyBlep(t, dt);
+            left[n] += sig * volumeL;
+            right[n] += sig * volumeR;
+        }
+        break;
+
+    case OSC_GENERATOR_BLEP_PULSE:
+        for (uint32_t n = 0U; n < len; n++)
+        {
+            addVal += (uint32_t)addValStep;
+            dt += dtStep;
+            samplePos += addVal;
+            const float t = ((float)samplePos) * phaseScale;
+            float sig = (t < pw) ? 1.0f : -1.0f;
+            sig += OscPolyBlep(t, dt) - OscPolyBlep(OscWrap(t + 1.0f - pw), dt);
+            left[n] += sig * volumeL;
+            right[n] += sig * volumeR;
+        }
+        break;
+
+    case OSC_GENERATOR_BLAMP_TRI:
+        for (uint32_t n = 0U; n < len; n++)
+        {
+            addVal += (uint32_t)addValStep;
+            dt += dtStep;
+            samplePos += addVal;
+            const float t = ((float)samplePos) * phaseScale;
+            /* the slope changes by 8 at both corners */
+            float sig = (t < 0.5f) ? (4.0f * t - 1.0f) : (3.0f - 4.0f * t);
+            sig += 8.0f * (OscPolyBlamp(t, dt) - OscPolyBlamp(OscWrap(t + 0.5f), dt));
+            left[n] += sig * volumeL;
+            right[n] += sig * volumeR;
+        }
+        break;
+
+    default:
+        for (uint32_t n = 0U; n < len; n++)
+        {
+            addVal += (uint32_t)addValStep;
+            samplePos += addVal;
+        }
+        break;
+    }
+
+    lane->samplePos[l] = samplePos;
+    lane->addVal[l] = addVal;
+}
+
+template<bool interpolate>
+static inline void OscVoiceSegmentGen(struct oscLaneT *lane, uint32_t l, float *left, float *right, uint32_t len, int32_t addValStep, float morphStep)
+{
+    switch (lane->generator[l])
+    {
+    case OSC_GENERATOR_TABLE:
+        OscVoiceSegment<interpolate>(lane, l, left, right, len, addValStep, morphStep);
+        break;
+    case OSC_GENERATOR_MORPH_TABLE:
+        OscVoiceSegmentFrames(lane, l, left, right, len, addValStep, morphStep);
+        break;
+    default:
+        OscVoiceSegmentBlep(lane, l, left, right, len, addValStep);
+        break;
+    }
+}
+
+template<bool interpolate>
+static void OscVoiceProcess(struct oscLaneT *lane, uint32_t l, float *left, float *right, uint32_t len)
+{
+    uint32_t n = 0;
+
+    if (lane->rampCnt[l] > 0)
+    {
+        n = (lane->rampCnt[l] < len) ? lane->rampCnt[l] : len;
+        OscVoiceSegmentGen<interpolate>(lane, l, left, right, n, lane->addValStep[l], lane->morphStep[l]);
+
+        lane->rampCnt[l] -= n;
+        if (lane->rampCnt[l] == 0)
+        {
+            /* remove the rounding error of the steps */
+            lane->addVal[l] = lane->addValTarget[l];
+            lane->morph[l] = lane->morphTarget[l];
+        }
+    }
+
+    if (n < len)
+    {
+        OscVoiceSegmentGen<interpolate>(lane, l, &left[n], &right[n], len - n, 0, 0.0f);
+    }
+}
+
+static void OscLaneProcess(struct oscLaneT *lane, float *left, float *right, uint32_t len)
+{
+    for (uint32_t l = 0; l < OSC_BANK_LANES; l++)
+    {
+        if (lane->waveForm[l] == oscSilence)
+        {
+            continue;
+        }
+
+        if (lane->waveBit[l] != 0)
+        {
+            OscVoiceProcess<true>(lane, l, left, right, len);
+        }
+        else
+        {
+            OscVoiceProcess<false>(lane, l, left, right, len);
+        }
+    }
+}
+
+/*
+ * compatibility wrapper, consecutive oscillators writing into the same buffers are processed together
+ * modulation changes are ramped over the whole block
+ */
 void OscProcess(oscillatorT *osc, int cnt, uint32_t len)
+{
+    struct oscLaneT lane;
+
+    int i = 0;
+    while (i < cnt)
+    {
+        uint32_t l = 0;
+        while ((l < OSC_BANK_LANES) && (i + (int)l < cnt)
+                && (osc[i + l].dest[0] == osc[i].dest[0]) && (osc[i + l].dest[1] == osc[i].dest[1]))
+        {
+            oscillatorT *o = &osc[i + l];
+            OscLaneClear(&lane, l);
+            lane.samplePos[l] = o->samplePos;
+            lane.addVal[l] = o->ctrlAddVal;
+            lane.addValTarget[l] = o->ctrlAddVal;
+            lane.morph[l] = o->ctrlMorph;
+            lane.morphTarget[l] = o->ctrlMorph;
+            lane.generator[l] = o->ctrlGenerator;
+            if ((o->pan_l != 0.0f) || (o->pan_r != 0.0f))
+            {
+                lane.panL[l] = o->pan_l;
+                lane.panR[l] = o->pan_r;
+            }
+            OscLaneLoad(&lane, l, o->cfg, o->addVal, *o->pitchMod, len);
+            l++;
+        }
+        for (uint32_t k = l; k < OSC_BANK_LANES; k++)
+        {
+            OscLaneClear(&lane, k);
+        }
+
+        OscLaneProcess(&lane, osc[i].dest[0], osc[i].dest[1], len);
+
+        for (uint32_t k = 0; k < l; k++)
+        {
+            osc[i + k].samplePos = lane.samplePos[k];
+            osc[i + k].ctrlAddVal = lane.addVal[k];
+            osc[i + k].ctrlMorph = lane.morph[k];
+            osc[i + k].ctrlGenerator = lane.generator[k];
+        }
+        i += l;
+    }
+}
+
+void Osc_SetPan(oscillatorT *osc, float pan)
+{
+    MlLut_PanGain(pan, &osc->pan_l, &osc->pan_r);
+}
+
+/*
+ * the fixed point version uses the integer morph depth in steps of 1/65536 of a period,
+ * it is reduced by two bits before the multiplication, the product of a full scale sample
+ * (up to 2^15) and the reduced depth (up to 2^15) stays within int32
+ */
+#define OSC_Q_MORPH_MAX ((1L << 17) - 1)
+
+static void OscProcessSingleQ(struct oscillatorQT *osc, uint32_t len)
+{
+    const struct synth_osc_cfg_s *cfg = osc->cfg;
+
+    /* conversion of the float parameters once per block */
+    const uint32_t addValTarget = (uint32_t)((*cfg->pitchMultiplier) * ((float)osc->addVal) * cfg->pitchOctave * cfg->pitch * *osc->pitchMod);
+    float morph_f = (*cfg->morph) * OSC_MORPH_SCALE;
+    morph_f = (morph_f > OSC_Q_MORPH_MAX) ? OSC_Q_MORPH_MAX : morph_f;
+    morph_f = (morph_f < -OSC_Q_MORPH_MAX) ? -OSC_Q_MORPH_MAX : morph_f;
+    const int32_t morphTarget = (int32_t)morph_f;
+    float volume_f = cfg->volume * 16384.0f;
+    volume_f = (volume_f > 32767.0f) ? 32767.0f : volume_f;
+    volume_f = (volume_f < -32768.0f) ? -32768.0f : volume_f;
+    const int32_t volume = (int32_t)volume_f;
+
+    /* ramp changes over the block, a voice starting from zero does not glide in */
+    uint32_t addVal = (osc->ctrlAddVal == 0) ? addValTarget : osc->ctrlAddVal;
+    int32_t morph = (osc->ctrlAddVal == 0) ? morphTarget : osc->ctrlMorph;
+    const int32_t addValDiff = (int32_t)(addValTarget - addVal);
+    const int32_t morphDiff = morphTarget - morph;
+    const int32_t addValStep = addValDiff / (int32_t)len;
+    const int32_t morphStep = morphDiff / (int32_t)len;
+
+    /* the remainder of the division is applied up front, the last step lands on the target */
+    addVal += (uint32_t)(addValDiff - addValStep * (int32_t)len);
+    morph += morphDiff - morphStep * (int32_t)len;
+
+    uint32_t samplePos = osc->samplePos;
+    const int16_t *waveForm = cfg->selectedWaveFormQ;
+    const int16_t *morphWaveForm = cfg->morphWaveFormQ;
+    Q1_14 *left = osc->dest[0];
+    Q1_14 *right = osc->dest[1];
+
+    for (uint32_t n = 0U; n < len; n++)
+    {
+        addVal += (uint32_t)addValStep;
+        morph += morphStep;
+        samplePos += addVal;
+
+        int32_t morphMod = ((int32_t)morphWaveForm[WAVEFORM_I(samplePos)] * (morph >> 2)) >> 12;
+        uint32_t pos = samplePos + ((uint32_t)morphMod << OSC_MORPH_SHIFT);
+
+        const int32_t sig = ((int32_t)waveForm[WAVEFORM_I(pos)] * volume) >> 14;
+
+        int32_t l = left[n].s16 + sig;
+        int32_t r = right[n].s16 + sig;
+        left[n].s16 = (l > INT16_MAX) ? INT16_MAX : ((l < INT16_MIN) ? INT16_MIN : l);
+        right[n].s16 = (r > INT16_MAX) ? INT16_MAX : ((r < INT16_MIN) ? INT16_MIN : r);
+    }
+
+    osc->samplePos = samplePos;
+    osc->ctrlAddVal = addVal;
+    osc->ctrlMorph = morph;
+}
+
+void OscProcessQ(struct oscillatorQT *osc, int cnt, uint32_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < cnt; i++)
+    {
+        OscProcessSingleQ(&osc[i], len);
+    }
+}
+
+void OscConvertWaveformQ(const float *waveForm, int16_t *waveFormQ)
+{
+    for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+    {
+        float q = waveForm[n] * 16384.0f;
+        q = (q > 32767.0f) ? 32767.0f : ((q < -32768.0f) ? -32768.0f : q);
+        waveFormQ[n] = (int16_t)((q >= 0.0f) ? (q + 0.5f) : (q - 0.5f));
+    }
+}
+
+/*
+ * the level is normalized to keep the power of the sum independent of the number of phases
+ */
+void OscUnison_SetVoices(struct oscUnisonT *uni, uint32_t cnt, float detune, float spread)
+{
+    cnt = (cnt < 1) ? 1 : cnt;
+    cnt = (cnt > OSC_UNISON_MAX) ? OSC_UNISON_MAX : cnt;
+    spread = (spread < 0.0f) ? 0.0f : spread;
+    spread = (spread > 1.0f) ? 1.0f : spread;
+
+    const float level = 1.0f / sqrtf((float)cnt);
+
+    for (uint32_t u = 0; u < cnt; u++)
+    {
+        /* position of the phase from -1 to 1 */
+        const float pos = (cnt > 1) ? ((2.0f * u) / (cnt - 1) - 1.0f) : 0.0f;
+
+        uni->detuneMul[u] = powf(2.0f, pos * detune * (1.0f / 12.0f));
+        MlLut_PanGain(pos * spread, &uni->gainL[u], &uni->gainR[u]);
+        uni->gainL[u] *= level;
+        uni->gainR[u] *= level;
+    }
+    uni->cnt = cnt;
+}
+
+/*
+ * the phases start spread over the period to avoid the initial peak of all phases in sync
+ */
+void OscUnison_ResetPhase(struct oscUnisonT *uni)
+{
+    for (uint32_t u = 0; u < OSC_UNISON_MAX; u++)
+    {
+        uni->samplePos[u] = u * 0x9E3779B9UL;
+    }
+}
+
+template<bool interpolate>
+static void OscUnisonRender(struct oscUnisonT *uni, const float *waveForm, uint32_t waveBit, const uint32_t *addVal, float volume, uint32_t len)
+{
+    const uint32_t cnt = uni->cnt;
+    float *left = uni->dest[0];
+    float *right = uni->dest[1];
+    uint32_t *samplePos = uni->samplePos;
+
+    float gainL[OSC_UNISON_MAX];
+    float gainR[OSC_UNISON_MAX];
+    for (uint32_t u = 0; u < cnt; u++)
+    {
+        gainL[u] = uni->gainL[u] * volume;
+        gainR[u] = uni->gainR[u] * volume;
+    }
+
+    uint32_t n = 0U;
+
+#if ML_SIMD
+    const uint32_t lenV = len - (len % ML_SIMD_LANES);
+
+    if (lenV > 0)
+    {
+        /* offsets of ML_SIMD_LANES consecutive samples of each phase */
+        ml_vi offsetV[OSC_UNISON_MAX];
+        for (uint32_t u = 0; u < cnt; u++)
+        {
+            uint32_t offset[ML_SIMD_LANES];
+            for (uint32_t k = 0; k < ML_SIMD_LANES; k++)
+            {
+                offset[k] = (k + 1) * addVal[u];
+            }
+            offsetV[u] = ml_vi_load(offset);
+        }
+
+        for (; n < lenV; n += ML_SIMD_LANES)
+        {
+            ml_vf accL = ml_vf_set1(0.0f);
+            ml_vf accR = ml_vf_set1(0.0f);
+
+            for (uint32_t u = 0; u < cnt; u++)
+            {
+                const ml_vi pos = ml_vi_add(ml_vi_set1((int32_t)samplePos[u]), offsetV[u]);
+                const ml_vf sig = OscReadV<interpolate>(waveForm, waveBit, pos);
+                accL = ml_vf_madd(accL, sig, ml_vf_set1(gainL[u]));
+                accR = ml_vf_madd(accR, sig, ml_vf_set1(gainR[u]));
+                samplePos[u] += ML_SIMD_LANES * addVal[u];
+            }
+
+            ml_vf_store(&left[n], ml_vf_add(ml_vf_load(&left[n]), accL));
+            ml_vf_store(&right[n], ml_vf_add(ml_vf_load(&right[n]), accR));
+        }
+    }
+#endif
+
+    for (; n < len; n++)
+    {
+        float accL = 0.0f;
+        float accR = 0.0f;
+
+        for (uint32_t u = 0; u < cnt; u++)
+        {
+            samplePos[u] += addVal[u];
+            const float sig = OscRead<interpolate>(waveForm, waveBit, samplePos[u]);
+            accL += sig * gainL[u];
+            accR += sig * gainR[u];
+        }
+
+        left[n] += accL;
+        right[n] += accR;
+    }
+}
+
+static void OscUnisonProcessSingle(struct oscUnisonT *uni, uint32_t len)
+{
+    const struct synth_osc_cfg_s *cfg = uni->cfg;
+
+    /* pitch is sampled once per block */
+    const float addValBase = (*cfg->pitchMultiplier) * ((float)uni->addVal) * cfg->pitchOctave * cfg->pitch * *uni->pitchMod;
+
+    uint32_t addVal[OSC_UNISON_MAX];
+    uint32_t maxAddVal = 0;
+    for (uint32_t u = 0; u < uni->cnt; u++)
+    {
+        addVal[u] = (uint32_t)(addValBase * uni->detuneMul[u]);
+        maxAddVal = (addVal[u] > maxAddVal) ? addVal[u] : maxAddVal;
+    }
+
+    if (cfg->selectedMipMap != NULL)
+    {
+        /* the highest phase selects the table for all */
+        const uint32_t level = OscMipMapLevel(maxAddVal);
+        OscUnisonRender<true>(uni, &cfg->selectedMipMap->data[OscMipMap_Offset(level)], OscMipMap_Bit(level), addVal, cfg->volume, len);
+    }
+    else
+    {
+        OscUnisonRender<false>(uni, cfg->selectedWaveForm, 0, addVal, cfg->volume, len);
+    }
+}
+
+void OscUnison_Process(struct oscUnisonT *uni, int cnt, uint32_t len)
 {
     for (int i = 0; i < cnt; i++)
     {
-        OscProcessSingle(&osc[i], len);
+        OscUnisonProcessSingle(&uni[i], len);
+    }
+}
+
+void OscBank_Init(struct oscBankT *bank)
+{
+    for (uint32_t g = 0; g < OSC_BANK_GROUPS; g++)
+    {
+        for (uint32_t l = 0; l < OSC_BANK_LANES; l++)
+        {
+            OscLaneClear(&bank->lane[g], l);
+        }
+        bank->activeCnt[g] = 0;
+    }
+    bank->ctrlRate = 0;
+    for (uint32_t v = 0; v < OSC_BANK_VOICES; v++)
+    {
+        bank->cfg[v] = NULL;
+        bank->pitchMod[v] = NULL;
+        bank->addVal[v] = 0;
+    }
+}
+
+void OscBank_SetVoice(struct oscBankT *bank, uint32_t voice, struct synth_osc_cfg_s *cfg, uint32_t addVal, float *pitchMod)
+{
+    if (voice >= OSC_BANK_VOICES)
+    {
+        return;
+    }
+
+    if (bank->cfg[voice] == NULL)
+    {
+        bank->activeCnt[voice / OSC_BANK_LANES]++;
+    }
+    /* a new note starts without ramp */
+    OscLaneClear(&bank->lane[voice / OSC_BANK_LANES], voice % OSC_BANK_LANES);
+    bank->cfg[voice] = cfg;
+    bank->pitchMod[voice] = pitchMod;
+    bank->addVal[voice] = addVal;
+}
+
+void OscBank_SetPitch(struct oscBankT *bank, uint32_t voice, uint32_t addVal)
+{
+    if (voice < OSC_BANK_VOICES)
+    {
+        bank->addVal[voice] = addVal;
+    }
+}
+
+/*
+ * pan from -1 (left) to 1 (right), call after OscBank_SetVoice
+ */
+void OscBank_SetPan(struct oscBankT *bank, uint32_t voice, float pan)
+{
+    if (voice < OSC_BANK_VOICES)
+    {
+        struct oscLaneT *lane = &bank->lane[voice / OSC_BANK_LANES];
+        MlLut_PanGain(pan, &lane->panL[voice % OSC_BANK_LANES], &lane->panR[voice % OSC_BANK_LANES]);
+    }
+}
+
+void OscBank_SetControlRate(struct oscBankT *bank, uint32_t samples)
+{
+    bank->ctrlRate = samples;
+}
+
+void OscBank_StopVoice(struct oscBankT *bank, uint32_t voice)
+{
+    if ((voice >= OSC_BANK_VOICES) || (bank->cfg[voice] == NULL))
+    {
+        return;
+    }
+
+    bank->cfg[voice] = NULL;
+    bank->activeCnt[voice / OSC_BANK_LANES]--;
+    OscLaneClear(&bank->lane[voice / OSC_BANK_LANES], voice % OSC_BANK_LANES);
+}
+
+void OscBank_Process(struct oscBankT *bank, float *left, float *right, uint32_t len)
+{
+    const uint32_t rampLen = (bank->ctrlRate > 0) ? bank->ctrlRate : len;
+
+    for (uint32_t g = 0; g < OSC_BANK_GROUPS; g++)
+    {
+        if (bank->activeCnt[g] == 0)
+        {
+            continue;
+        }
+
+        struct oscLaneT *lane = &bank->lane[g];
+        for (uint32_t l = 0; l < OSC_BANK_LANES; l++)
+        {
+            const uint32_t v = g * OSC_BANK_LANES + l;
+            if ((v < OSC_BANK_VOICES) && (bank->cfg[v] != NULL))
+            {
+                OscLaneLoad(lane, l, bank->cfg[v], bank->addVal[v], (bank->pitchMod[v] != NULL) ? *bank->pitchMod[v] : 1.0f, rampLen);
+            }
+        }
+
+        OscLaneProcess(lane, left, right, len);
+    }
+}
+
+/*
+ * creates the band limited tables by removing the harmonics above the limit of each level
+ * this is done once during setup, the result can be shared by all voices
+ */
+void OscMipMap_Build(struct oscMipMapT *mipMap, const float *waveForm)
+{
+    /* level 0 contains all harmonics which can be represented by the table */
+    for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+    {
+        mipMap->data[n] = waveForm[n];
+    }
+    mipMap->data[WAVEFORM_CNT] = waveForm[0];
+
+    float dc = 0.0f;
+    for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+    {
+        dc += waveForm[n];
+    }
+    dc *= 1.0f / WAVEFORM_CNT;
+
+    for (uint32_t level = 1; level < OSC_MIPMAP_LEVELS; level++)
+    {
+        float *tbl = &mipMap->data[OscMipMap_Offset(level)];
+        for (uint32_t n = 0; n < (1UL << OscMipMap_Bit(level)); n++)
+        {
+            tbl[n] = dc;
+        }
+    }
+
+    for (uint32_t k = 1; k <= ((uint32_t)WAVEFORM_CNT / 2) >> 1; k++)
+    {
+        /* analysis of harmonic k using a rotating phasor */
+        float re = 0.0f;
+        float im = 0.0f;
+        const float rotC = cosf(2.0f * M_PI * k / WAVEFORM_CNT);
+        const float rotS = sinf(2.0f * M_PI * k / WAVEFORM_CNT);
+        float c = 1.0f;
+        float s = 0.0f;
+        for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+        {
+            re += waveForm[n] * c;
+            im += waveForm[n] * s;
+            const float cn = c * rotC - s * rotS;
+            s = c * rotS + s * rotC;
+            c = cn;
+        }
+        re *= 2.0f / WAVEFORM_CNT;
+        im *= 2.0f / WAVEFORM_CNT;
+
+        /* synthesis into all levels which contain the harmonic */
+        for (uint32_t level = 1; (level < OSC_MIPMAP_LEVELS) && (k <= (((uint32_t)WAVEFORM_CNT / 2) >> level)); level++)
+        {
+            const uint32_t size = 1UL << OscMipMap_Bit(level);
+            float *tbl = &mipMap->data[OscMipMap_Offset(level)];
+            const float synC = cosf(2.0f * M_PI * k / size);
+            const float synS = sinf(2.0f * M_PI * k / size);
+            c = 1.0f;
+            s = 0.0f;
+            for (uint32_t n = 0; n < size; n++)
+            {
+                tbl[n] += re * c + im * s;
+                const float cn = c * synC - s * synS;
+                s = c * synS + s * synC;
+                c = cn;
+            }
+        }
+    }
+
+    for (uint32_t level = 1; level < OSC_MIPMAP_LEVELS; level++)
+    {
+        float *tbl = &mipMap->data[OscMipMap_Offset(level)];
+        tbl[1UL << OscMipMap_Bit(level)] = tbl[0];
+    }
+}
+
+/*
+ * frame f uses the phase offset morph with the depth morphMax * f / (OSC_MORPH_FRAMES - 1),
+ * the result is the same as the per sample morph of OSC_GENERATOR_TABLE
+ */
+void OscMorphTable_BuildPhase(struct oscMorphTableT *table, const float *waveForm, const float *morphWaveForm, float morphMax)
+{
+    for (uint32_t f = 0; f < OSC_MORPH_FRAMES; f++)
+    {
+        const float morph = morphMax * OSC_MORPH_SCALE * ((float)f) / ((float)(OSC_MORPH_FRAMES - 1));
+        float *frame = &table->data[f * WAVEFORM_CNT];
+        for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+        {
+            const uint32_t samplePos = n << (32 - WAVEFORM_BIT);
+            int32_t morphMod = (int32_t)(morphWaveForm[n] * morph);
+            uint32_t pos = samplePos + ((uint32_t)morphMod << OSC_MORPH_SHIFT);
+            frame[n] = waveForm[WAVEFORM_I(pos)];
+        }
+    }
+}
+
+/*
+ * crossfade from one waveform to another, the frames can also be written directly
+ */
+void OscMorphTable_BuildBlend(struct oscMorphTableT *table, const float *waveFormFrom, const float *waveFormTo)
+{
+    for (uint32_t f = 0; f < OSC_MORPH_FRAMES; f++)
+    {
+        const float mix = ((float)f) / ((float)(OSC_MORPH_FRAMES - 1));
+        float *frame = &table->data[f * WAVEFORM_CNT];
+        for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+        {
+            frame[n] = waveFormFrom[n] + (waveFormTo[n] - waveFormFrom[n]) * mix;
+        }
     }
 }
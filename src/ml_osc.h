@@ -49,8 +49,72 @@
 
 
 #include <Arduino.h>
+#include <ml_simd.h>
+#include <ml_types.h>
+#include <ml_waveform.h>
 
 
+/*
+ * band limited copies of a waveform, one level per octave
+ * - level n contains the harmonics up to (WAVEFORM_CNT / 2) >> n
+ * - the tables get shorter with fewer harmonics but never shorter than 1 << OSC_MIPMAP_MIN_BIT
+ * - every table has one extra sample (copy of the first one) used by the interpolation
+ */
+#ifndef OSC_MIPMAP_LEVELS
+#define OSC_MIPMAP_LEVELS   10
+#endif
+#define OSC_MIPMAP_MIN_BIT  6
+
+#if OSC_MIPMAP_LEVELS > WAVEFORM_BIT
+#error "OSC_MIPMAP_LEVELS must not be greater than WAVEFORM_BIT"
+#endif
+
+constexpr uint32_t OscMipMap_Bit(uint32_t level)
+{
+    return ((int)WAVEFORM_BIT + 1 - (int)level > (int)WAVEFORM_BIT) ? WAVEFORM_BIT :
+           (((int)WAVEFORM_BIT + 1 - (int)level < OSC_MIPMAP_MIN_BIT) ? OSC_MIPMAP_MIN_BIT : WAVEFORM_BIT + 1 - level);
+}
+
+constexpr uint32_t OscMipMap_Offset(uint32_t level)
+{
+    return (level == 0) ? 0 : OscMipMap_Offset(level - 1) + (1UL << OscMipMap_Bit(level - 1)) + 1;
+}
+
+struct oscMipMapT
+{
+    float data[OscMipMap_Offset(OSC_MIPMAP_LEVELS)];
+};
+
+/*
+ * wavetable morphing with precomputed frames
+ * - the frames are calculated once when a waveform is assigned
+ * - *morph from 0 to 1 selects the position between the first and the last frame,
+ *   the two nearest frames are mixed, this costs one interpolation per sample
+ * - memory usage is OSC_MORPH_FRAMES * WAVEFORM_CNT * 4 bytes per table
+ */
+#ifndef OSC_MORPH_FRAMES
+#define OSC_MORPH_FRAMES    8
+#endif
+
+#if OSC_MORPH_FRAMES < 2
+#error "OSC_MORPH_FRAMES must be at least 2"
+#endif
+
+struct oscMorphTableT
+{
+    float data[OSC_MORPH_FRAMES * WAVEFORM_CNT]; /* frame f starts at f * WAVEFORM_CNT */
+};
+
+/*
+ * sound generators of the oscillator
+ * the PolyBLEP generators calculate the waveform without any table
+ */
+#define OSC_GENERATOR_TABLE         0 /* reads selectedWaveForm or selectedMipMap */
+#define OSC_GENERATOR_BLEP_SAW      1
+#define OSC_GENERATOR_BLEP_PULSE    2 /* pulse width is set by pulseWidth */
+#define OSC_GENERATOR_BLAMP_TRI     3
+#define OSC_GENERATOR_MORPH_TABLE   4 /* reads the frames of morphTable, *morph selects the frame */
+
 struct synth_osc_cfg_s
 {
     uint8_t pitchOctave; /* multiplier to go to higher octaves */
@@ -63,6 +127,17 @@ struct synth_osc_cfg_s
     float *morphWaveForm;
 
     float *morph; /* points source of morph value */
+
+    const struct oscMipMapT *selectedMipMap; /* optional band limited version of selectedWaveForm, NULL to use the table directly */
+
+    uint8_t generator; /* OSC_GENERATOR_... */
+    float pulseWidth; /* 0 .. 1, used by OSC_GENERATOR_BLEP_PULSE */
+
+    const struct oscMorphTableT *morphTable; /* used by OSC_GENERATOR_MORPH_TABLE, NULL falls back to selectedWaveForm */
+
+    /* fixed point versions of the waveforms, used by OscProcessQ */
+    const int16_t *selectedWaveFormQ;
+    const int16_t *morphWaveFormQ;
 };
 
 struct oscillatorT
@@ -71,14 +146,131 @@ struct oscillatorT
     float *dest[2];
     uint32_t samplePos;
     uint32_t addVal;
-    float pan_l;
+    float pan_l; /* gains of the channels, both zero: signal goes unchanged to both channels */
     float pan_r;
     float *pitchMod;
     struct synth_osc_cfg_s *cfg;
+
+    /* used by OscProcess to ramp modulation changes, keep zero when starting a new note */
+    uint32_t ctrlAddVal;
+    float ctrlMorph;
+    uint8_t ctrlGenerator; /* generator of the last block, the morph units depend on it */
+};
+
+
+/*
+ * fixed point oscillator for platforms without FPU
+ * uses the same configuration, floats are only converted once per block
+ */
+struct oscillatorQT
+{
+    Q1_14 *dest[2];
+    uint32_t samplePos;
+    uint32_t addVal;
+    float *pitchMod;
+    struct synth_osc_cfg_s *cfg;
+
+    /* used by OscProcessQ to ramp modulation changes, keep zero when starting a new note */
+    uint32_t ctrlAddVal;
+    int32_t ctrlMorph;
+};
+
+/*
+ * unison oscillator (supersaw when used with a saw waveform)
+ * - up to OSC_UNISON_MAX detuned phases per note are rendered in a single pass
+ * - the phases are summed in registers, the output buffers are accessed once per sample
+ * - detune is the pitch of the outer phases in semitones (+/-), the others are spread evenly in between
+ * - spread is the stereo width from 0 (mono) to 1 (outer phases hard left/right),
+ *   the phases are panned like Osc_SetPan and the level is scaled by 1 / sqrt(cnt)
+ * - reads selectedWaveForm or selectedMipMap, morph and the table free generators are not supported
+ */
+#define OSC_UNISON_MAX  16
+
+struct oscUnisonT
+{
+    float *dest[2];
+    uint32_t addVal;
+    float *pitchMod;
+    struct synth_osc_cfg_s *cfg;
+
+    /* set by OscUnison_SetVoices */
+    uint32_t cnt;
+    float detuneMul[OSC_UNISON_MAX];
+    float gainL[OSC_UNISON_MAX];
+    float gainR[OSC_UNISON_MAX];
+
+    uint32_t samplePos[OSC_UNISON_MAX];
+};
+
+/*
+ * voice bank
+ * - voices are stored as structure of arrays, OSC_BANK_LANES voices form a lane group
+ * - all values which do not change within a block are read once per block
+ * - pitch and morph are sampled once per block (control rate), changes are ramped linearly
+ *   over ctrlRate samples (0: over the whole block) to avoid zipper noise
+ * - all voices of the bank are mixed into the same stereo output,
+ *   a voice goes to both channels with full level until OscBank_SetPan is called
+ */
+#define OSC_BANK_LANES  ML_SIMD_LANES
+
+#ifndef OSC_BANK_VOICES
+#define OSC_BANK_VOICES 64
+#endif
+
+#define OSC_BANK_GROUPS ((OSC_BANK_VOICES + OSC_BANK_LANES - 1) / OSC_BANK_LANES)
+
+struct oscLaneT
+{
+    uint32_t samplePos[OSC_BANK_LANES];
+    uint32_t addVal[OSC_BANK_LANES]; /* current phase increment */
+    uint32_t addValTarget[OSC_BANK_LANES];
+    int32_t addValStep[OSC_BANK_LANES];
+    float volume[OSC_BANK_LANES];
+    float morph[OSC_BANK_LANES]; /* current morph depth or frame position */
+    float morphTarget[OSC_BANK_LANES];
+    float morphStep[OSC_BANK_LANES];
+    uint32_t rampCnt[OSC_BANK_LANES]; /* remaining samples of the current ramp */
+    const float *waveForm[OSC_BANK_LANES];
+    const float *morphWaveForm[OSC_BANK_LANES];
+    uint8_t waveBit[OSC_BANK_LANES]; /* size of the band limited table, 0 when reading the raw waveform */
+    uint8_t generator[OSC_BANK_LANES];
+    float pulseWidth[OSC_BANK_LANES];
+    float panL[OSC_BANK_LANES];
+    float panR[OSC_BANK_LANES];
+};
+
+struct oscBankT
+{
+    struct oscLaneT lane[OSC_BANK_GROUPS];
+    struct synth_osc_cfg_s *cfg[OSC_BANK_VOICES]; /* NULL when the voice is not used */
+    float *pitchMod[OSC_BANK_VOICES]; /* optional, NULL means no modulation */
+    uint32_t addVal[OSC_BANK_VOICES];
+    uint8_t activeCnt[OSC_BANK_GROUPS];
+    uint32_t ctrlRate; /* length of the modulation ramps in samples, 0: length of the block */
 };
 
 
 void OscProcess(oscillatorT *osc, int cnt, uint32_t len);
+void Osc_SetPan(oscillatorT *osc, float pan);
+
+void OscProcessQ(struct oscillatorQT *osc, int cnt, uint32_t len);
+void OscConvertWaveformQ(const float *waveForm, int16_t *waveFormQ);
+
+void OscUnison_SetVoices(struct oscUnisonT *uni, uint32_t cnt, float detune, float spread);
+void OscUnison_ResetPhase(struct oscUnisonT *uni);
+void OscUnison_Process(struct oscUnisonT *uni, int cnt, uint32_t len);
+
+void OscMipMap_Build(struct oscMipMapT *mipMap, const float *waveForm);
+void OscMorphTable_BuildPhase(struct oscMorphTableT *table, const float *waveForm, const float *morphWaveForm, float morphMax);
+void OscMorphTable_BuildBlend(struct oscMorphTableT *table, const float *waveFormFrom, const float *waveFormTo);
+
+void OscBank_Init(struct oscBankT *bank);
+void OscBank_SetVoice(struct oscBankT *bank, uint32_t voice, struct synth_osc_cfg_s *cfg, uint32_t addVal, float *pitchMod);
+void OscBank_SetPitch(struct oscBankT *bank, uint32_t voice, uint32_t addVal);
+void OscBank_SetPan(struct oscBankT *bank, uint32_t voice, float pan);
+void OscBank_SetControlRate(struct oscBankT *bank, uint32_t samples);
+void OscBank_StopVoice(struct oscBankT *bank, uint32_t voice);
+void OscBank_Process(struct oscBankT *bank, float *left, float *right, uint32_t len);
 
 
 #endif /* ML_OSC_H_ */
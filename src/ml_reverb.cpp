@@ -55,163 +55,121 @@
 
 
 #include <ml_reverb.h>
+#include <ml_denormal.h>
+#include <ml_ring.h>
 
 
-static float rev_time = 1.0f;
-static float rev_level = 0.0f;
-
-
-struct comb_s
-{
-    float *buf;
-    int p;
-    float g;
-    int lim;
-};
+/*
+ * default instance used by the Reverb_ functions
+ */
+static ML_Reverb reverbDefault;
 
-static struct comb_s cf0 =
-{
-    NULL,
-    0,
-    0.805f,
-    (int)(rev_time * l_CB0),
-};
 
-static struct comb_s cf1 =
+static void Do_Comb(struct comb_s *cf, const float *inSample, float *outSample, int buffLen)
 {
-    NULL,
-    0,
-    0.827f,
-    (int)(rev_time * l_CB1),
-};
+    /* the block is split into at most two runs, the inner loop has no wrap check */
+    for (int n = 0; n < buffLen;)
+    {
+        const int run = Ring_Run(cf->p, cf->lim, buffLen - n);
+        float *buf = &cf->buf[cf->p];
+        const float g = cf->g;
 
-static struct comb_s cf2 =
-{
-    NULL,
-    0,
-    0.783f,
-    (int)(rev_time * l_CB2),
-};
+        for (int k = 0; k < run; k++)
+        {
+            float readback = buf[k];
+            buf[k] = readback * g + inSample[n + k];
+            outSample[n + k] += readback;
+        }
 
-static struct comb_s cf3 =
-{
-    NULL,
-    0,
-    0.764f,
-    (int)(rev_time * l_CB3),
-};
+        n += run;
+        cf->p = Ring_Wrap(cf->p + run, cf->lim);
+    }
+}
 
-static void Do_Comb(struct comb_s *cf, const float *inSample, float *outSample, int buffLen)
+static void Do_Allpass(struct allpass_s *ap, float *inSample, int buffLen)
 {
-    for (int n = 0; n < buffLen; n++)
+    for (int n = 0; n < buffLen;)
     {
-        float readback = cf->buf[cf->p];
-        float newV = readback * cf->g + inSample[n];
-        cf->buf[cf->p] = newV;
-        cf->p++;
-        if (cf->p >= cf->lim)
+        const int run = Ring_Run(ap->p, ap->lim, buffLen - n);
+        float *buf = &ap->buf[ap->p];
+        const float g = ap->g;
+
+        for (int k = 0; k < run; k++)
         {
-            cf->p = 0;
+            float readback = buf[k];
+            readback += (-g) * inSample[n + k];
+            buf[k] = readback * g + inSample[n + k];
+            inSample[n + k] = readback;
         }
-        outSample[n] += readback;
+
+        n += run;
+        ap->p = Ring_Wrap(ap->p + run, ap->lim);
     }
 }
 
-struct allpass_s
-{
-    float *buf;
-    int p;
-    float g;
-    int lim;
-};
+/*
+ * the block is processed in parts of fixed length, the temporary buffers on the stack
+ * do not depend on the block length given by the caller
+ */
+#define REVERB_PART_LEN 32
 
-static struct allpass_s ap0 =
+void ML_Reverb::process(float *signal_l, int buffLen)
 {
-    NULL,
-    0,
-    0.7f,
-    (int)(rev_time * l_AP0)
-};
+    ML_DenormalGuard denormalGuard;
 
-static struct allpass_s ap1 =
-{
-    NULL,
-    0,
-    0.7f,
-    (int)(rev_time * l_AP1)
-};
+    while (buffLen > 0)
+    {
+        const int len = (buffLen < REVERB_PART_LEN) ? buffLen : REVERB_PART_LEN;
 
-static struct allpass_s ap2 =
-{
-    NULL,
-    0,
-    0.7f,
-    (int)(rev_time * l_AP2)
-};
+        float inSample[REVERB_PART_LEN];
+        float newsample[REVERB_PART_LEN];
+        for (int n = 0; n < len; n++)
+        {
+            /* create mono sample */
+            inSample[n] = signal_l[n] + ML_DENORMAL_DC; /* it may cause unwanted audible effects */
+            newsample[n] = 0.0f;
+        }
 
-static void Do_Allpass(struct allpass_s *ap, float *inSample, int buffLen)
-{
-    for (int n = 0; n < buffLen; n++)
-    {
-        float readback = ap->buf[ap->p];
-        readback += (-ap->g) * inSample[n];
-        float newV = readback * ap->g + inSample[n];
-        ap->buf[ap->p] = newV;
-        ap->p++;
-        if (ap->p >= ap->lim)
+        Do_Comb(&cf0, inSample, newsample, len);
+        Do_Comb(&cf1, inSample, newsample, len);
+        Do_Comb(&cf2, inSample, newsample, len);
+        Do_Comb(&cf3, inSample, newsample, len);
+        for (int n = 0; n < len; n++)
         {
-            ap->p = 0;
+            newsample[n] *= 0.25f;
         }
-        inSample[n] = readback;
-    }
-}
 
-void Reverb_Process(float *signal_l, int buffLen)
-{
-    float inSample[buffLen];
-    for (int n = 0; n < buffLen; n++)
-    {
-        /* create mono sample */
-        inSample[n] = signal_l[n]; /* it may cause unwanted audible effects */
-    }
-    float newsample[buffLen];
-    memset(newsample, 0, sizeof(newsample));
-    Do_Comb(&cf0, inSample, newsample, buffLen);
-    Do_Comb(&cf1, inSample, newsample, buffLen);
-    Do_Comb(&cf2, inSample, newsample, buffLen);
-    Do_Comb(&cf3, inSample, newsample, buffLen);
-    for (int n = 0; n < buffLen; n++)
-    {
-        newsample[n] *= 0.25f;
-    }
+        Do_Allpass(&ap0, newsample, len);
+        Do_Allpass(&ap1, newsample, len);
+        Do_Allpass(&ap2, newsample, len);
 
-    Do_Allpass(&ap0, newsample, buffLen);
-    Do_Allpass(&ap1, newsample, buffLen);
-    Do_Allpass(&ap2, newsample, buffLen);
+        /* apply reverb level */
+        for (int n = 0; n < len; n++)
+        {
+            newsample[n] *= rev_level;
+            signal_l[n] += newsample[n];
+        }
 
-    /* apply reverb level */
-    for (int n = 0; n < buffLen; n++)
-    {
-        newsample[n] *= rev_level;
-        signal_l[n] += newsample[n];
+        signal_l += len;
+        buffLen -= len;
     }
 }
 
-static int CombInit(float *buffer, int i, struct comb_s *cf, int len)
+static int CombInit(float *buffer, int i, struct comb_s *cf, int len, float rev_time)
 {
     cf->buf = &buffer[i];
     cf->lim = (int)(rev_time * len);
     return len;
 }
 
-static int AllpassInit(float *buffer, int i, struct allpass_s *ap, int len)
+static int AllpassInit(float *buffer, int i, struct allpass_s *ap, int len, float rev_time)
 {
     ap->buf = &buffer[i];
     ap->lim = (int)(rev_time * len);
     return len;
 }
 
-void Reverb_Setup(float *buffer)
+void ML_Reverb::setup(float *buffer)
 {
     if (buffer == NULL)
     {
@@ -224,14 +182,14 @@ void Reverb_Setup(float *buffer)
     }
     int i = 0;
 
-    i += CombInit(buffer, i, &cf0, l_CB0);
-    i += CombInit(buffer, i, &cf1, l_CB1);
-    i += CombInit(buffer, i, &cf2, l_CB2);
-    i += CombInit(buffer, i, &cf3, l_CB3);
+    i += CombInit(buffer, i, &cf0, l_CB0, rev_time);
+    i += CombInit(buffer, i, &cf1, l_CB1, rev_time);
+    i += CombInit(buffer, i, &cf2, l_CB2, rev_time);
+    i += CombInit(buffer, i, &cf3, l_CB3, rev_time);
 
-    i += AllpassInit(buffer, i, &ap0, l_AP0);
-    i += AllpassInit(buffer, i, &ap1, l_AP1);
-    i += AllpassInit(buffer, i, &ap2, l_AP2);
+    i += AllpassInit(buffer, i, &ap0, l_AP0, rev_time);
+    i += AllpassInit(buffer, i, &ap1, l_AP1, rev_time);
+    i += AllpassInit(buffer, i, &ap2, l_AP2, rev_time);
 
 #if 0
     cf0.buf = &buffer[i];
@@ -273,14 +231,32 @@ void Reverb_Setup(float *buffer)
     }
 }
 
-void Reverb_SetLevel(uint8_t not_used __attribute__((unused)), float value)
+void ML_Reverb::setLevel(float value)
 {
     rev_level = value;
 }
 
+/*
+ * functions of the default instance
+ */
+void Reverb_Process(float *signal_l, int buffLen)
+{
+    reverbDefault.process(signal_l, buffLen);
+}
+
+void Reverb_Setup(float *buffer)
+{
+    reverbDefault.setup(buffer);
+}
+
+void Reverb_SetLevel(uint8_t not_used __attribute__((unused)), float value)
+{
+    reverbDefault.setLevel(value);
+}
+
 void Reverb_SetLevelInt(uint8_t not_used, uint8_t value)
 {
     float val_f = value;
     val_f *= 1.0f / 127.0f;
-    Reverb_SetLevel(not_used, value);
+    Reverb_SetLevel(not_used, val_f);
 }
@@ -62,6 +62,50 @@
 #define REV_BUFF_SIZE   (l_CB0 + l_CB1 + l_CB2 + l_CB3 + l_AP0 + l_AP1 + l_AP2)
 
 
+struct comb_s
+{
+    float *buf;
+    int p;
+    float g;
+    int lim;
+};
+
+struct allpass_s
+{
+    float *buf;
+    int p;
+    float g;
+    int lim;
+};
+
+/*
+ * one reverb effect, the buffer of REV_BUFF_SIZE floats is provided by the caller
+ * the Reverb_ functions below use a default instance
+ */
+class ML_Reverb
+{
+public:
+    ML_Reverb() {};
+    ~ML_Reverb() {};
+    void setup(float *buffer);
+    void process(float *signal_l, int buffLen);
+    void setLevel(float value);
+
+private:
+    float rev_time = 1.0f;
+    float rev_level = 0.0f;
+
+    struct comb_s cf0 = {NULL, 0, 0.805f, l_CB0};
+    struct comb_s cf1 = {NULL, 0, 0.827f, l_CB1};
+    struct comb_s cf2 = {NULL, 0, 0.783f, l_CB2};
+    struct comb_s cf3 = {NULL, 0, 0.764f, l_CB3};
+
+    struct allpass_s ap0 = {NULL, 0, 0.7f, l_AP0};
+    struct allpass_s ap1 = {NULL, 0, 0.7f, l_AP1};
+    struct allpass_s ap2 = {NULL, 0, 0.7f, l_AP2};
+};
+
+
 void Reverb_Process(float *signal_l, int buffLen);
 void Reverb_Setup(float *buffer);
 void Reverb_SetLevel(uint8_t not_used, float value);
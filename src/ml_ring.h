@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_ring.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains helpers for delay lines stored in ring buffers.
+ *
+ * Block processing: a block is split into runs which end when one of the positions wraps.
+ * The loop inside a run needs no wrap check, a position wraps only between two runs.
+ * With one position there are at most two runs per block, each additional tap adds at most one.
+ *
+ * Fractional reads: Ring_Positions calculates the read positions of one tap for a whole block
+ * with integer adds only, Ring_ReadLinear and Ring_ReadHermite interpolate between the samples.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_RING_H_
+#define SRC_ML_RING_H_
+
+
+#include <stdint.h>
+
+
+/* idx must be below 2 * len, the compiler uses a conditional move or select here */
+static inline uint32_t Ring_Wrap(uint32_t idx, uint32_t len)
+{
+    return (idx >= len) ? (idx - len) : idx;
+}
+
+/* returns how many of n samples can be processed from idx on until it wraps */
+static inline uint32_t Ring_Run(uint32_t idx, uint32_t len, uint32_t n)
+{
+    return ((len - idx) < n) ? (len - idx) : n;
+}
+
+
+/*
+ * calculates the read positions of one tap for n samples
+ * pos: write position of the first sample
+ * delay: delay of the first sample in samples, must be in [0, len)
+ * step: change of the delay from one sample to the next, must be in [-1, 1]
+ * the float values are converted once, the loop accumulates a 16 bit fraction
+ */
+static inline void Ring_Positions(uint32_t pos, uint32_t len, float delay, float step, uint32_t *idx, float *frac, uint32_t n)
+{
+    const uint32_t delayInt = (uint32_t)delay;
+    uint32_t f = (uint32_t)((delay - delayInt) * 65536.0f);
+    uint32_t i = pos + len - delayInt;
+    if (f > 0)
+    {
+        i -= 1;
+        f = 0x10000 - f;
+    }
+    i = Ring_Wrap(i, len);
+
+    /* the read position moves by one sample minus the change of the delay */
+    const uint32_t inc = (uint32_t)((1.0f - step) * 65536.0f);
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        idx[k] = i;
+        frac[k] = f * (1.0f / 65536.0f);
+        f += inc;
+        i = Ring_Wrap(i + (f >> 16), len);
+        f &= 0xFFFF;
+    }
+}
+
+static inline float Ring_Linear(float x0, float x1, float frac)
+{
+    return x0 + frac * (x1 - x0);
+}
+
+/* 4-point 3rd order hermite interpolation between x0 and x1 */
+static inline float Ring_Hermite(float xm1, float x0, float x1, float x2, float frac)
+{
+    const float c1 = 0.5f * (x1 - xm1);
+    const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+
+    return ((c3 * frac + c2) * frac + c1) * frac + x0;
+}
+
+/* linear interpolation between idx and idx + 1 */
+static inline float Ring_ReadLinear(const int16_t *buf, uint32_t len, uint32_t idx, float frac)
+{
+    return Ring_Linear(buf[idx], buf[Ring_Wrap(idx + 1, len)], frac);
+}
+
+/* hermite interpolation, reads idx - 1 to idx + 2 */
+static inline float Ring_ReadHermite(const int16_t *buf, uint32_t len, uint32_t idx, float frac)
+{
+    return Ring_Hermite(buf[(idx == 0) ? (len - 1) : (idx - 1)], buf[idx], buf[Ring_Wrap(idx + 1, len)], buf[Ring_Wrap(idx + 2, len)], frac);
+}
+
+
+#endif /* SRC_ML_RING_H_ */
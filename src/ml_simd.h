@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_simd.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains a thin wrapper around the vector units of the host platforms
+ * (AVX2, SSE2, NEON). It is used by the voice bank kernels to process several voices at once.
+ * ML_SIMD is 0 on all other platforms and the kernels fall back to their scalar code.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_SIMD_H_
+#define SRC_ML_SIMD_H_
+
+
+#include <stdint.h>
+
+
+#if (defined __AVX2__)
+#include <immintrin.h>
+#define ML_SIMD         1
+#define ML_SIMD_LANES   8
+typedef __m256 ml_vf;
+typedef __m256i ml_vi;
+#elif (defined __SSE2__)
+#include <emmintrin.h>
+#define ML_SIMD         1
+#define ML_SIMD_LANES   4
+typedef __m128 ml_vf;
+typedef __m128i ml_vi;
+#elif (defined __ARM_NEON) || (defined __ARM_NEON__)
+#include <arm_neon.h>
+#define ML_SIMD         1
+#define ML_SIMD_LANES   4
+typedef float32x4_t ml_vf;
+typedef int32x4_t ml_vi;
+#else
+#define ML_SIMD         0
+#define ML_SIMD_LANES   4 /* keeps the same data layout, processed voice by voice */
+#endif
+
+
+#if ML_SIMD
+
+static inline ml_vf ml_vf_load(const float *p)
+{
+#if (defined __AVX2__)
+    return _mm256_loadu_ps(p);
+#elif (defined __SSE2__)
+    return _mm_loadu_ps(p);
+#else
+    return vld1q_f32(p);
+#endif
+}
+
+static inline void ml_vf_store(float *p, ml_vf a)
+{
+#if (defined __AVX2__)
+    _mm256_storeu_ps(p, a);
+#elif (defined __SSE2__)
+    _mm_storeu_ps(p, a);
+#else
+    vst1q_f32(p, a);
+#endif
+}
+
+static inline ml_vf ml_vf_set1(float a)
+{
+#if (defined __AVX2__)
+    return _mm256_set1_ps(a);
+#elif (defined __SSE2__)
+    return _mm_set1_ps(a);
+#else
+    return vdupq_n_f32(a);
+#endif
+}
+
+static inline ml_vf ml_vf_add(ml_vf a, ml_vf b)
+{
+#if (defined __AVX2__)
+    return _mm256_add_ps(a, b);
+#elif (defined __SSE2__)
+    return _mm_add_ps(a, b);
+#else
+    return vaddq_f32(a, b);
+#endif
+}
+
+static inline ml_vf ml_vf_sub(ml_vf a, ml_vf b)
+{
+#if (defined __AVX2__)
+    return _mm256_sub_ps(a, b);
+#elif (defined __SSE2__)
+    return _mm_sub_ps(a, b);
+#else
+    return vsubq_f32(a, b);
+#endif
+}
+
+static inline ml_vf ml_vf_mul(ml_vf a, ml_vf b)
+{
+#if (defined __AVX2__)
+    return _mm256_mul_ps(a, b);
+#elif (defined __SSE2__)
+    return _mm_mul_ps(a, b);
+#else
+    return vmulq_f32(a, b);
+#endif
+}
+
+/* returns a + b * c */
+static inline ml_vf ml_vf_madd(ml_vf a, ml_vf b, ml_vf c)
+{
+#if (defined __AVX2__) || (defined __SSE2__)
+    return ml_vf_add(a, ml_vf_mul(b, c));
+#else
+    return vmlaq_f32(a, b, c);
+#endif
+}
+
+static inline ml_vf ml_vf_div(ml_vf a, ml_vf b)
+{
+#if (defined __AVX2__)
+    return _mm256_div_ps(a, b);
+#elif (defined __SSE2__)
+    return _mm_div_ps(a, b);
+#elif (defined __aarch64__)
+    return vdivq_f32(a, b);
+#else
+    /* ARMv7 has no vector division, the estimate is refined by two newton steps */
+    float32x4_t r = vrecpeq_f32(b);
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    return vmulq_f32(a, r);
+#endif
+}
+
+static inline ml_vf ml_vf_min(ml_vf a, ml_vf b)
+{
+#if (defined __AVX2__)
+    return _mm256_min_ps(a, b);
+#elif (defined __SSE2__)
+    return _mm_min_ps(a, b);
+#else
+    return vminq_f32(a, b);
+#endif
+}
+
+static inline ml_vf ml_vf_max(ml_vf a, ml_vf b)
+{
+#if (defined __AVX2__)
+    return _mm256_max_ps(a, b);
+#elif (defined __SSE2__)
+    return _mm_max_ps(a, b);
+#else
+    return vmaxq_f32(a, b);
+#endif
+}
+
+static inline ml_vi ml_vi_load(const void *p)
+{
+#if (defined __AVX2__)
+    return _mm256_loadu_si256((const __m256i *)p);
+#elif (defined __SSE2__)
+    return _mm_loadu_si128((const __m128i *)p);
+#else
+    return vld1q_s32((const int32_t *)p);
+#endif
+}
+
+static inline void ml_vi_store(void *p, ml_vi a)
+{
+#if (defined __AVX2__)
+    _mm256_storeu_si256((__m256i *)p, a);
+#elif (defined __SSE2__)
+    _mm_storeu_si128((__m128i *)p, a);
+#else
+    vst1q_s32((int32_t *)p, a);
+#endif
+}
+
+/* wraps around like uint32_t does, can be used for phase accumulators */
+static inline ml_vi ml_vi_add(ml_vi a, ml_vi b)
+{
+#if (defined __AVX2__)
+    return _mm256_add_epi32(a, b);
+#elif (defined __SSE2__)
+    return _mm_add_epi32(a, b);
+#else
+    return vaddq_s32(a, b);
+#endif
+}
+
+/* logical shift right, the upper bits are filled with zeros */
+static inline ml_vi ml_vi_srl(ml_vi a, int n)
+{
+#if (defined __AVX2__)
+    return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n));
+#elif (defined __SSE2__)
+    return _mm_srl_epi32(a, _mm_cvtsi32_si128(n));
+#else
+    return vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a), vdupq_n_s32(-n)));
+#endif
+}
+
+static inline ml_vi ml_vi_sll(ml_vi a, int n)
+{
+#if (defined __AVX2__)
+    return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n));
+#elif (defined __SSE2__)
+    return _mm_sll_epi32(a, _mm_cvtsi32_si128(n));
+#else
+    return vshlq_s32(a, vdupq_n_s32(n));
+#endif
+}
+
+/* float to int conversion rounding towards zero */
+static inline ml_vi ml_vf_to_vi(ml_vf a)
+{
+#if (defined __AVX2__)
+    return _mm256_cvttps_epi32(a);
+#elif (defined __SSE2__)
+    return _mm_cvttps_epi32(a);
+#else
+    return vcvtq_s32_f32(a);
+#endif
+}
+
+static inline ml_vi ml_vi_set1(int32_t a)
+{
+#if (defined __AVX2__)
+    return _mm256_set1_epi32(a);
+#elif (defined __SSE2__)
+    return _mm_set1_epi32(a);
+#else
+    return vdupq_n_s32(a);
+#endif
+}
+
+static inline ml_vf ml_vi_to_vf(ml_vi a)
+{
+#if (defined __AVX2__)
+    return _mm256_cvtepi32_ps(a);
+#elif (defined __SSE2__)
+    return _mm_cvtepi32_ps(a);
+#else
+    return vcvtq_f32_s32(a);
+#endif
+}
+
+/* reads tbl[idx[l]] for every lane l */
+static inline ml_vf ml_vf_gather1(const float *tbl, ml_vi idx)
+{
+#if (defined __AVX2__)
+    return _mm256_i32gather_ps(tbl, idx, 4);
+#else
+    int32_t i[ML_SIMD_LANES];
+    float f[ML_SIMD_LANES];
+
+    ml_vi_store(i, idx);
+    for (int l = 0; l < ML_SIMD_LANES; l++)
+    {
+        f[l] = tbl[i[l]];
+    }
+    return ml_vf_load(f);
+#endif
+}
+
+/*
+ * transposes ML_SIMD_LANES vectors, afterwards r[k] contains element k of all input vectors
+ */
+static inline void ml_vf_transpose(ml_vf *r)
+{
+#if (defined __AVX2__)
+    const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+#elif (defined __SSE2__)
+    _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+#else
+    const float32x4x2_t p01 = vtrnq_f32(r[0], r[1]);
+    const float32x4x2_t p23 = vtrnq_f32(r[2], r[3]);
+    r[0] = vcombine_f32(vget_low_f32(p01.val[0]), vget_low_f32(p23.val[0]));
+    r[1] = vcombine_f32(vget_low_f32(p01.val[1]), vget_low_f32(p23.val[1]));
+    r[2] = vcombine_f32(vget_high_f32(p01.val[0]), vget_high_f32(p23.val[0]));
+    r[3] = vcombine_f32(vget_high_f32(p01.val[1]), vget_high_f32(p23.val[1]));
+#endif
+}
+
+#endif /* ML_SIMD */
+
+
+#endif /* SRC_ML_SIMD_H_ */
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_tap_delay.cpp
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This is an implementation of a multi tap s16 delay line
+ * - up to TAP_DELAY_TAPS_MAX taps reading from one shared line
+ * - length, gain, pan and feedback per tap
+ * - ping pong preset using two taps
+ */
+
+
+#ifdef __CDT_PARSER__
+#include <cdt.h>
+#endif
+
+
+#include <ml_tap_delay.h>
+#include <ml_lut.h>
+#include <ml_ring.h>
+#include <ml_status.h>
+
+
+#ifndef ARDUINO
+#include <stdio.h>
+#endif
+
+
+/*
+ * default instance used by the TapDelay_ functions
+ */
+static ML_TapDelay tapDelayDefault;
+
+
+void ML_TapDelay::init(int16_t *buffer, uint32_t len)
+{
+    line = buffer;
+    lineLenMax = len;
+
+    if (line == NULL)
+    {
+        printf("Not enough memory available for tap delay line!\n");
+        lineLenMax = 0;
+    }
+
+    for (uint8_t t = 0; t < TAP_DELAY_TAPS_MAX; t++)
+    {
+        setTapLength(t, tapLen[t]);
+    }
+
+    reset();
+}
+
+void ML_TapDelay::reset(void)
+{
+    lineIn = 0;
+
+    for (uint32_t i = 0; i < lineLenMax; i++)
+    {
+        line[i] = 0;
+    }
+}
+
+void ML_TapDelay::process(const float *in, float *left, float *right, int buffLen)
+{
+    if (lineLenMax == 0)
+    {
+        return;
+    }
+
+    const uint8_t cnt = tapCnt;
+    uint32_t pos[TAP_DELAY_TAPS_MAX];
+    const int16_t *rd[TAP_DELAY_TAPS_MAX];
+
+    for (uint8_t t = 0; t < cnt; t++)
+    {
+        pos[t] = Ring_Wrap(lineIn + lineLenMax - tapLen[t], lineLenMax);
+    }
+
+    /* a run ends when the write position or one of the taps wraps */
+    for (int n = 0; n < buffLen;)
+    {
+        uint32_t run = Ring_Run(lineIn, lineLenMax, buffLen - n);
+        for (uint8_t t = 0; t < cnt; t++)
+        {
+            run = Ring_Run(pos[t], lineLenMax, run);
+            rd[t] = &line[pos[t]];
+        }
+
+        int16_t *wr = &line[lineIn];
+
+        for (uint32_t k = 0; k < run; k++, n++)
+        {
+            float outL = 0.0f;
+            float outR = 0.0f;
+            float fb = ((float)0x4000) * in[n] * inLvl;
+
+            /* every tap is read once and used for both outputs and the feedback */
+            for (uint8_t t = 0; t < cnt; t++)
+            {
+                const float s = rd[t][k];
+                outL += s * tapGainL[t];
+                outR += s * tapGainR[t];
+                fb += s * tapFeedback[t];
+            }
+
+            left[n] += outL;
+            right[n] += outR;
+
+            /* the sum of several taps can exceed the line format */
+            fb = fb > 32767.0f ? 32767.0f : (fb < -32768.0f ? -32768.0f : fb);
+            wr[k] = (int16_t)fb;
+        }
+
+        lineIn = Ring_Wrap(lineIn + run, lineLenMax);
+        for (uint8_t t = 0; t < cnt; t++)
+        {
+            pos[t] = Ring_Wrap(pos[t] + run, lineLenMax);
+        }
+    }
+}
+
+void ML_TapDelay::updateGain(uint8_t tap)
+{
+    float panL, panR;
+    MlLut_PanGain(tapPan[tap], &panL, &panR);
+    tapGainL[tap] = tapGain[tap] * panL / ((float)0x4000);
+    tapGainR[tap] = tapGain[tap] * panR / ((float)0x4000);
+}
+
+void ML_TapDelay::setInputLevel(float value)
+{
+    inLvl = value;
+}
+
+void ML_TapDelay::setTapCount(uint8_t count)
+{
+    tapCnt = count < TAP_DELAY_TAPS_MAX ? count : TAP_DELAY_TAPS_MAX;
+}
+
+void ML_TapDelay::setTap(uint8_t tap, uint32_t length, float gain, float pan, float feedback)
+{
+    if (tap >= TAP_DELAY_TAPS_MAX)
+    {
+        return;
+    }
+
+    tapGain[tap] = gain;
+    tapPan[tap] = pan;
+    setTapLength(tap, length);
+    updateGain(tap);
+    setTapFeedback(tap, feedback);
+}
+
+/*
+ * the length is given in samples, a tap reads at least one sample behind the write position
+ */
+void ML_TapDelay::setTapLength(uint8_t tap, uint32_t length)
+{
+    if (tap >= TAP_DELAY_TAPS_MAX)
+    {
+        return;
+    }
+
+    /* lengths set before init are limited by init */
+    if ((lineLenMax > 0) && (length > lineLenMax))
+    {
+        length = lineLenMax;
+    }
+    tapLen[tap] = length > 0 ? length : 1;
+}
+
+void ML_TapDelay::setTapGain(uint8_t tap, float value)
+{
+    if (tap >= TAP_DELAY_TAPS_MAX)
+    {
+        return;
+    }
+
+    tapGain[tap] = value;
+    updateGain(tap);
+}
+
+/*
+ * -1: left, 0: center, 1: right
+ */
+void ML_TapDelay::setTapPan(uint8_t tap, float value)
+{
+    if (tap >= TAP_DELAY_TAPS_MAX)
+    {
+        return;
+    }
+
+    tapPan[tap] = value;
+    updateGain(tap);
+}
+
+void ML_TapDelay::setTapFeedback(uint8_t tap, float value)
+{
+    if (tap >= TAP_DELAY_TAPS_MAX)
+    {
+        return;
+    }
+
+    tapFeedback[tap] = value;
+}
+
+/*
+ * the first tap is heard on the left, the second one a length later on the right
+ * only the second tap is fed back, so the echoes keep alternating between both sides
+ */
+void ML_TapDelay::setPingPong(uint32_t length, float feedback)
+{
+    setTap(0, length, 1.0f, -1.0f, 0.0f);
+    setTap(1, 2 * length, 1.0f, 1.0f, feedback);
+    setTapCount(2);
+}
+
+/*
+ * functions of the default instance
+ */
+void TapDelay_Init(int16_t *buffer, uint32_t len)
+{
+    tapDelayDefault.init(buffer, len);
+}
+
+void TapDelay_Reset(void)
+{
+    tapDelayDefault.reset();
+}
+
+void TapDelay_Process_Buff(const float *in, float *left, float *right, int buffLen)
+{
+    tapDelayDefault.process(in, left, right, buffLen);
+}
+
+void TapDelay_SetInputLevel(uint8_t unused __attribute__((unused)), float value)
+{
+    tapDelayDefault.setInputLevel(value);
+    Status_ValueChangedFloat("TapDelay_SetInputLevel", value);
+}
+
+void TapDelay_SetTapCount(uint8_t unused __attribute__((unused)), float value)
+{
+    tapDelayDefault.setTapCount((uint8_t)(value * TAP_DELAY_TAPS_MAX));
+    Status_ValueChangedInt("TapDelay_SetTapCount", tapDelayDefault.getTapCount());
+}
+
+/*
+ * value is the length relative to the line
+ */
+void TapDelay_SetTapLength(uint8_t tap, float value)
+{
+    tapDelayDefault.setTapLength(tap, (uint32_t)(((float)tapDelayDefault.getLengthMax()) * value));
+    Status_ValueChangedIntArr("TapDelay_SetTapLength", tapDelayDefault.getTapLength(tap), tap);
+}
+
+void TapDelay_SetTapGain(uint8_t tap, float value)
+{
+    tapDelayDefault.setTapGain(tap, value);
+    Status_ValueChangedFloatArr("TapDelay_SetTapGain", value, tap);
+}
+
+/*
+ * value 0..1 is mapped to left..right
+ */
+void TapDelay_SetTapPan(uint8_t tap, float value)
+{
+    tapDelayDefault.setTapPan(tap, value * 2.0f - 1.0f);
+    Status_ValueChangedFloatArr("TapDelay_SetTapPan", value, tap);
+}
+
+void TapDelay_SetTapFeedback(uint8_t tap, float value)
+{
+    tapDelayDefault.setTapFeedback(tap, value);
+    Status_ValueChangedFloatArr("TapDelay_SetTapFeedback", value, tap);
+}
+
+/*
+ * value is the length of one ping relative to half of the line
+ */
+void TapDelay_SetPingPong(uint8_t unused __attribute__((unused)), float value)
+{
+    tapDelayDefault.setPingPong((uint32_t)(((float)tapDelayDefault.getLengthMax()) * 0.5f * value), 0.5f);
+    Status_ValueChangedFloat("TapDelay_SetPingPong", value);
+}
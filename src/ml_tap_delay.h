@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_tap_delay.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains the declarations of a multi tap delay effect
+ */
+
+
+#ifndef SRC_ML_TAP_DELAY_H_
+#define SRC_ML_TAP_DELAY_H_
+
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+#define TAP_DELAY_TAPS_MAX  8
+
+
+/*
+ * all taps read from one mono line and are calculated in the same pass over the block
+ * each tap has its own length, gain, pan and feedback into the line
+ * the buffer is provided by the caller, the TapDelay_ functions below use a default instance
+ */
+class ML_TapDelay
+{
+public:
+    ML_TapDelay() {};
+    ~ML_TapDelay() {};
+    void init(int16_t *buffer, uint32_t len);
+    void reset(void);
+    void process(const float *in, float *left, float *right, int buffLen);
+    void setInputLevel(float value);
+    void setTapCount(uint8_t count);
+    void setTap(uint8_t tap, uint32_t length, float gain, float pan, float feedback);
+    void setTapLength(uint8_t tap, uint32_t length);
+    void setTapGain(uint8_t tap, float value);
+    void setTapPan(uint8_t tap, float value);
+    void setTapFeedback(uint8_t tap, float value);
+    void setPingPong(uint32_t length, float feedback);
+    uint8_t getTapCount(void) { return tapCnt; };
+    uint32_t getTapLength(uint8_t tap) { return tapLen[tap]; };
+    uint32_t getLengthMax(void) { return lineLenMax; };
+
+private:
+    void updateGain(uint8_t tap);
+
+    int16_t *line = NULL;
+    uint32_t lineLenMax = 0;
+    uint32_t lineIn = 0;
+    float inLvl = 1.0f;
+    uint8_t tapCnt = 0;
+
+    uint32_t tapLen[TAP_DELAY_TAPS_MAX] = {0};
+    float tapGain[TAP_DELAY_TAPS_MAX] = {0};
+    float tapPan[TAP_DELAY_TAPS_MAX] = {0};
+    float tapGainL[TAP_DELAY_TAPS_MAX] = {0}; /* gain and pan together, scaled from the line format */
+    float tapGainR[TAP_DELAY_TAPS_MAX] = {0};
+    float tapFeedback[TAP_DELAY_TAPS_MAX] = {0};
+};
+
+
+void TapDelay_Init(int16_t *buffer, uint32_t len);
+void TapDelay_Reset(void);
+void TapDelay_Process_Buff(const float *in, float *left, float *right, int buffLen);
+void TapDelay_SetInputLevel(uint8_t unused __attribute__((unused)), float value);
+void TapDelay_SetTapCount(uint8_t unused __attribute__((unused)), float value);
+void TapDelay_SetTapLength(uint8_t tap, float value);
+void TapDelay_SetTapGain(uint8_t tap, float value);
+void TapDelay_SetTapPan(uint8_t tap, float value);
+void TapDelay_SetTapFeedback(uint8_t tap, float value);
+void TapDelay_SetPingPong(uint8_t unused __attribute__((unused)), float value);
+
+
+#endif /* SRC_ML_TAP_DELAY_H_ */
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_trig.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains polynomial approximations of sin, cos and tan.
+ *
+ * The argument is given in half turns: ml_sin_pi(x) = sin(pi * x).
+ * This matches the normalized frequencies used by the filters (omega = fc / (fs / 2)).
+ *
+ * - the argument is reduced to -0.5 .. 0.5 without tables and branches, valid for |x| < 2^21
+ *   (strict float evaluation is required, see ML_TRIG_ROUND)
+ * - sin(pi * r) is an odd minimax polynomial of 9th degree (error of the polynomial 3.3e-9)
+ * - measured maximum absolute error of ml_sin_pi and ml_cos_pi in float: 2e-7 (-4 <= x <= 4)
+ * - ml_tan_pi is sin / cos, measured relative error 2.4e-7 up to x = 0.49
+ *
+ * The vector versions calculate the same values for ML_SIMD_LANES arguments.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_TRIG_H_
+#define SRC_ML_TRIG_H_
+
+
+#include <ml_simd.h>
+
+#include <float.h>
+#include <math.h>
+
+
+/*
+ * adding and subtracting 1.5 * 2^23 rounds to the nearest integer
+ * this needs strict float evaluation: -ffast-math removes the two operations
+ * and x87 excess precision (FLT_EVAL_METHOD != 0) keeps the sum unrounded,
+ * nearbyintf is used instead in these cases
+ */
+#define ML_TRIG_ROUND   12582912.0f
+
+#if (defined __FAST_MATH__) || (defined FLT_EVAL_METHOD && (FLT_EVAL_METHOD != 0))
+#define ML_TRIG_ROUND_LIBM  1
+#else
+#define ML_TRIG_ROUND_LIBM  0
+#endif
+
+#define ML_TRIG_S1      3.141592580935982f
+#define ML_TRIG_S3      -5.167706936090734f
+#define ML_TRIG_S5      2.550032339504841f
+#define ML_TRIG_S7      -0.5980510494995808f
+#define ML_TRIG_S9      0.07723189914172132f
+
+
+/* returns x reduced to one period: -1 .. 1, the result is exact */
+static inline float ml_trig_reduce(float x)
+{
+    const float h = x * 0.5f;
+#if ML_TRIG_ROUND_LIBM
+    return 2.0f * (h - nearbyintf(h));
+#else
+    return 2.0f * (h - ((h + ML_TRIG_ROUND) - ML_TRIG_ROUND));
+#endif
+}
+
+/* sin(pi * r) for r in -0.5 .. 0.5 */
+static inline float ml_trig_poly(float r)
+{
+    const float r2 = r * r;
+    return r * (ML_TRIG_S1 + r2 * (ML_TRIG_S3 + r2 * (ML_TRIG_S5 + r2 * (ML_TRIG_S7 + r2 * ML_TRIG_S9))));
+}
+
+static inline float ml_sin_pi(float x)
+{
+    const float t = ml_trig_reduce(x);
+    /* sin(pi * t) = sin(pi * (1 - t)) = sin(pi * (-1 - t)) */
+    float r = (t > 0.5f) ? (1.0f - t) : t;
+    r = (r < -0.5f) ? (-1.0f - r) : r;
+    return ml_trig_poly(r);
+}
+
+static inline float ml_cos_pi(float x)
+{
+    const float t = ml_trig_reduce(x);
+    /* cos(pi * t) = sin(pi * (0.5 - |t|)), the subtraction is exact close to the zero crossing */
+    return ml_trig_poly(0.5f - ((t < 0.0f) ? -t : t));
+}
+
+static inline void ml_sincos_pi(float x, float *s, float *c)
+{
+    const float t = ml_trig_reduce(x);
+    float r = (t > 0.5f) ? (1.0f - t) : t;
+    r = (r < -0.5f) ? (-1.0f - r) : r;
+    *s = ml_trig_poly(r);
+    *c = ml_trig_poly(0.5f - ((t < 0.0f) ? -t : t));
+}
+
+static inline float ml_tan_pi(float x)
+{
+    float s, c;
+    ml_sincos_pi(x, &s, &c);
+    return s / c;
+}
+
+
+#if ML_SIMD
+
+static inline ml_vf ml_vf_trig_reduce(ml_vf x)
+{
+#if ML_TRIG_ROUND_LIBM
+    /* the vector operations are folded the same way, the lanes are reduced one by one */
+    float v[ML_SIMD_LANES];
+    ml_vf_store(v, x);
+    for (int l = 0; l < ML_SIMD_LANES; l++)
+    {
+        v[l] = ml_trig_reduce(v[l]);
+    }
+    return ml_vf_load(v);
+#else
+    const ml_vf round = ml_vf_set1(ML_TRIG_ROUND);
+    const ml_vf h = ml_vf_mul(x, ml_vf_set1(0.5f));
+    const ml_vf hr = ml_vf_sub(h, ml_vf_sub(ml_vf_add(h, round), round));
+    return ml_vf_add(hr, hr);
+#endif
+}
+
+static inline ml_vf ml_vf_trig_poly(ml_vf r)
+{
+    const ml_vf r2 = ml_vf_mul(r, r);
+    ml_vf p = ml_vf_madd(ml_vf_set1(ML_TRIG_S7), r2, ml_vf_set1(ML_TRIG_S9));
+    p = ml_vf_madd(ml_vf_set1(ML_TRIG_S5), r2, p);
+    p = ml_vf_madd(ml_vf_set1(ML_TRIG_S3), r2, p);
+    p = ml_vf_madd(ml_vf_set1(ML_TRIG_S1), r2, p);
+    return ml_vf_mul(r, p);
+}
+
+static inline ml_vf ml_vf_sin_pi(ml_vf x)
+{
+    const ml_vf t = ml_vf_trig_reduce(x);
+    const ml_vf r = ml_vf_max(ml_vf_min(t, ml_vf_sub(ml_vf_set1(1.0f), t)), ml_vf_sub(ml_vf_set1(-1.0f), t));
+    return ml_vf_trig_poly(r);
+}
+
+static inline ml_vf ml_vf_cos_pi(ml_vf x)
+{
+    const ml_vf t = ml_vf_trig_reduce(x);
+    const ml_vf a = ml_vf_max(t, ml_vf_sub(ml_vf_set1(0.0f), t));
+    return ml_vf_trig_poly(ml_vf_sub(ml_vf_set1(0.5f), a));
+}
+
+static inline void ml_vf_sincos_pi(ml_vf x, ml_vf *s, ml_vf *c)
+{
+    const ml_vf t = ml_vf_trig_reduce(x);
+    const ml_vf r = ml_vf_max(ml_vf_min(t, ml_vf_sub(ml_vf_set1(1.0f), t)), ml_vf_sub(ml_vf_set1(-1.0f), t));
+    const ml_vf a = ml_vf_max(t, ml_vf_sub(ml_vf_set1(0.0f), t));
+    *s = ml_vf_trig_poly(r);
+    *c = ml_vf_trig_poly(ml_vf_sub(ml_vf_set1(0.5f), a));
+}
+
+static inline ml_vf ml_vf_tan_pi(ml_vf x)
+{
+    ml_vf s, c;
+    ml_vf_sincos_pi(x, &s, &c);
+    return ml_vf_div(s, c);
+}
+
+#endif /* ML_SIMD */
+
+
+#endif /* SRC_ML_TRIG_H_ */
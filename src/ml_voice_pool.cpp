@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_voice_pool.cpp
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains the implementation of the voice allocator
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#include "ml_voice_pool.h"
+
+
+static void VoicePool_ListRemove(struct voicePoolT *pool, uint8_t voice)
+{
+    const uint8_t p = pool->prev[voice];
+    const uint8_t n = pool->next[voice];
+
+    if (p != VOICE_POOL_NONE)
+    {
+        pool->next[p] = n;
+    }
+    else
+    {
+        pool->head = n;
+    }
+
+    if (n != VOICE_POOL_NONE)
+    {
+        pool->prev[n] = p;
+    }
+    else
+    {
+        pool->tail = p;
+    }
+
+    pool->prev[voice] = VOICE_POOL_NONE;
+    pool->next[voice] = VOICE_POOL_NONE;
+    pool->activeCnt--;
+}
+
+static void VoicePool_ListAppend(struct voicePoolT *pool, uint8_t voice)
+{
+    pool->prev[voice] = pool->tail;
+    pool->next[voice] = VOICE_POOL_NONE;
+
+    if (pool->tail != VOICE_POOL_NONE)
+    {
+        pool->next[pool->tail] = voice;
+    }
+    else
+    {
+        pool->head = voice;
+    }
+    pool->tail = voice;
+    pool->activeCnt++;
+}
+
+static void VoicePool_IndexRemove(struct voicePoolT *pool, uint8_t voice)
+{
+    /* the chain only contains the voices of a single note */
+    uint8_t *link = &pool->noteVoice[pool->note[voice]];
+    while (*link != VOICE_POOL_NONE)
+    {
+        if (*link == voice)
+        {
+            *link = pool->noteNext[voice];
+            break;
+        }
+        link = &pool->noteNext[*link];
+    }
+    pool->noteNext[voice] = VOICE_POOL_NONE;
+}
+
+static void VoicePool_IndexAdd(struct voicePoolT *pool, uint8_t voice)
+{
+    pool->noteNext[voice] = pool->noteVoice[pool->note[voice]];
+    pool->noteVoice[pool->note[voice]] = voice;
+}
+
+void VoicePool_Init(struct voicePoolT *pool, uint8_t cnt)
+{
+    cnt = (cnt > VOICE_POOL_MAX) ? VOICE_POOL_MAX : cnt;
+    pool->cnt = cnt;
+
+    /* the first voice is taken first */
+    pool->freeCnt = cnt;
+    for (uint8_t i = 0; i < cnt; i++)
+    {
+        pool->freeList[i] = cnt - 1 - i;
+    }
+
+    pool->head = VOICE_POOL_NONE;
+    pool->tail = VOICE_POOL_NONE;
+    pool->activeCnt = 0;
+
+    for (uint8_t i = 0; i < 128; i++)
+    {
+        pool->noteVoice[i] = VOICE_POOL_NONE;
+    }
+
+    for (uint8_t i = 0; i < VOICE_POOL_MAX; i++)
+    {
+        pool->prev[i] = VOICE_POOL_NONE;
+        pool->next[i] = VOICE_POOL_NONE;
+        pool->noteNext[i] = VOICE_POOL_NONE;
+        pool->ch[i] = 0;
+        pool->note[i] = 0;
+        pool->state[i] = VOICE_STATE_FREE;
+    }
+
+    pool->level = NULL;
+    pool->levelArg = NULL;
+    VoicePool_SetPolicy(pool, VOICE_STEAL_OLDEST);
+}
+
+void VoicePool_SetPolicy(struct voicePoolT *pool, uint8_t policy)
+{
+    switch (policy)
+    {
+    case VOICE_STEAL_QUIETEST:
+        pool->steal = VoicePool_StealQuietest;
+        pool->retrigger = false;
+        break;
+    case VOICE_STEAL_SAME_NOTE:
+        pool->steal = VoicePool_StealOldest;
+        pool->retrigger = true;
+        break;
+    case VOICE_STEAL_OLDEST:
+    default:
+        pool->steal = VoicePool_StealOldest;
+        pool->retrigger = false;
+        break;
+    }
+}
+
+/*
+ * custom policy, it must return an active voice
+ */
+void VoicePool_SetStealFn(struct voicePoolT *pool, voicePoolStealFn steal)
+{
+    pool->steal = steal;
+}
+
+/*
+ * used by VOICE_STEAL_QUIETEST, typically returns the envelope level of the voice
+ */
+void VoicePool_SetLevelFn(struct voicePoolT *pool, voicePoolLevelFn level, void *arg)
+{
+    pool->level = level;
+    pool->levelArg = arg;
+}
+
+uint8_t VoicePool_StealOldest(const struct voicePoolT *pool, uint8_t ch __attribute__((unused)), uint8_t note __attribute__((unused)))
+{
+    return pool->head;
+}
+
+/*
+ * this is the only policy which scans the active voices
+ */
+uint8_t VoicePool_StealQuietest(const struct voicePoolT *pool, uint8_t ch __attribute__((unused)), uint8_t note __attribute__((unused)))
+{
+    if (pool->level == NULL)
+    {
+        return pool->head;
+    }
+
+    uint8_t quietest = pool->head;
+    float minLevel = 0.0f;
+    for (uint8_t v = pool->head; v != VOICE_POOL_NONE; v = pool->next[v])
+    {
+        const float level = pool->level(v, pool->levelArg);
+        if ((v == pool->head) || (level < minLevel))
+        {
+            minLevel = level;
+            quietest = v;
+        }
+    }
+    return quietest;
+}
+
+uint8_t VoicePool_Find(const struct voicePoolT *pool, uint8_t ch, uint8_t note)
+{
+    for (uint8_t v = pool->noteVoice[note & 0x7F]; v != VOICE_POOL_NONE; v = pool->noteNext[v])
+    {
+        if (pool->ch[v] == ch)
+        {
+            return v;
+        }
+    }
+    return VOICE_POOL_NONE;
+}
+
+/*
+ * returns the voice which should play the note, stolen is set when the voice was playing before
+ */
+uint8_t VoicePool_NoteOn(struct voicePoolT *pool, uint8_t ch, uint8_t note, bool *stolen)
+{
+    note &= 0x7F;
+    uint8_t voice = VOICE_POOL_NONE;
+    bool wasActive = false;
+
+    if (pool->retrigger)
+    {
+        voice = VoicePool_Find(pool, ch, note);
+        wasActive = (voice != VOICE_POOL_NONE);
+    }
+
+    if ((voice == VOICE_POOL_NONE) && (pool->freeCnt > 0))
+    {
+        pool->freeCnt--;
+        voice = pool->freeList[pool->freeCnt];
+    }
+
+    if ((voice == VOICE_POOL_NONE) && (pool->activeCnt > 0))
+    {
+        voice = pool->steal(pool, ch, note);
+        wasActive = true;
+    }
+
+    if (voice == VOICE_POOL_NONE)
+    {
+        /* pool has been initialized without voices */
+        return VOICE_POOL_NONE;
+    }
+
+    if (wasActive)
+    {
+        VoicePool_ListRemove(pool, voice);
+        VoicePool_IndexRemove(pool, voice);
+    }
+
+    pool->ch[voice] = ch;
+    pool->note[voice] = note;
+    pool->state[voice] = VOICE_STATE_HELD;
+    VoicePool_ListAppend(pool, voice);
+    VoicePool_IndexAdd(pool, voice);
+
+    if (stolen != NULL)
+    {
+        *stolen = wasActive;
+    }
+    return voice;
+}
+
+/*
+ * returns the released voice, the voice stays active until VoicePool_Free is called
+ */
+uint8_t VoicePool_NoteOff(struct voicePoolT *pool, uint8_t ch, uint8_t note)
+{
+    for (uint8_t v = pool->noteVoice[note & 0x7F]; v != VOICE_POOL_NONE; v = pool->noteNext[v])
+    {
+        if ((pool->ch[v] == ch) && (pool->state[v] == VOICE_STATE_HELD))
+        {
+            pool->state[v] = VOICE_STATE_RELEASED;
+            return v;
+        }
+    }
+    return VOICE_POOL_NONE;
+}
+
+void VoicePool_Free(struct voicePoolT *pool, uint8_t voice)
+{
+    if ((voice >= pool->cnt) || (pool->state[voice] == VOICE_STATE_FREE))
+    {
+        return;
+    }
+
+    VoicePool_ListRemove(pool, voice);
+    VoicePool_IndexRemove(pool, voice);
+    pool->state[voice] = VOICE_STATE_FREE;
+    pool->freeList[pool->freeCnt] = voice;
+    pool->freeCnt++;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2023 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ml_voice_pool.h
+ * @author Marcel Licence
+ * @date 18.10.2026
+ *
+ * @brief This file contains a voice allocator with constant time note on/off.
+ *
+ * Free voices are kept on a stack, active voices in a list ordered by their start time
+ * (oldest first) and a note index points to the voices playing a note.
+ * A note on does not scan the voices unless a voice has to be stolen with the
+ * quietest policy. Rendering only iterates the active list:
+ *
+ * for (uint8_t v = VoicePool_First(&pool); v != VOICE_POOL_NONE; v = VoicePool_Next(&pool, v))
+ *
+ * Read the next index before a voice is freed within the loop.
+ *
+ * The voice index returned by the pool is the index into the array of voices of the caller
+ * (oscillators, envelopes, ...). The caller returns a voice with VoicePool_Free when it
+ * has finished its release.
+ */
+
+
+#ifdef __CDT_PARSER__
+#include "cdt.h"
+#endif
+
+
+#ifndef SRC_ML_VOICE_POOL_H_
+#define SRC_ML_VOICE_POOL_H_
+
+
+#include <Arduino.h>
+
+
+#ifndef VOICE_POOL_MAX
+#define VOICE_POOL_MAX  32
+#endif
+
+#if VOICE_POOL_MAX > 255
+#error "VOICE_POOL_MAX must be below 255"
+#endif
+
+#define VOICE_POOL_NONE 0xFF
+
+#define VOICE_STATE_FREE        0
+#define VOICE_STATE_HELD        1 /* key is pressed */
+#define VOICE_STATE_RELEASED    2 /* key is released, voice is still sounding */
+
+/*
+ * stealing policies, used when no free voice is left
+ */
+#define VOICE_STEAL_OLDEST      0 /* voice started first */
+#define VOICE_STEAL_QUIETEST    1 /* lowest level reported by the level callback */
+#define VOICE_STEAL_SAME_NOTE   2 /* a voice playing the same note is retriggered, otherwise the oldest one is used */
+
+struct voicePoolT;
+
+typedef uint8_t (*voicePoolStealFn)(const struct voicePoolT *pool, uint8_t ch, uint8_t note);
+typedef float (*voicePoolLevelFn)(uint8_t voice, void *arg);
+
+struct voicePoolT
+{
+    uint8_t cnt;
+
+    uint8_t freeList[VOICE_POOL_MAX];
+    uint8_t freeCnt;
+
+    /* active voices, oldest at head */
+    uint8_t head;
+    uint8_t tail;
+    uint8_t prev[VOICE_POOL_MAX];
+    uint8_t next[VOICE_POOL_MAX];
+    uint8_t activeCnt;
+
+    /* note index, all voices of a note are chained */
+    uint8_t noteVoice[128];
+    uint8_t noteNext[VOICE_POOL_MAX];
+
+    uint8_t ch[VOICE_POOL_MAX];
+    uint8_t note[VOICE_POOL_MAX];
+    uint8_t state[VOICE_POOL_MAX];
+
+    voicePoolStealFn steal;
+    bool retrigger; /* reuse a voice playing the same note */
+    voicePoolLevelFn level;
+    void *levelArg;
+};
+
+
+void VoicePool_Init(struct voicePoolT *pool, uint8_t cnt);
+void VoicePool_SetPolicy(struct voicePoolT *pool, uint8_t policy);
+void VoicePool_SetStealFn(struct voicePoolT *pool, voicePoolStealFn steal);
+void VoicePool_SetLevelFn(struct voicePoolT *pool, voicePoolLevelFn level, void *arg);
+uint8_t VoicePool_NoteOn(struct voicePoolT *pool, uint8_t ch, uint8_t note, bool *stolen);
+uint8_t VoicePool_NoteOff(struct voicePoolT *pool, uint8_t ch, uint8_t note);
+uint8_t VoicePool_Find(const struct voicePoolT *pool, uint8_t ch, uint8_t note);
+void VoicePool_Free(struct voicePoolT *pool, uint8_t voice);
+
+uint8_t VoicePool_StealOldest(const struct voicePoolT *pool, uint8_t ch, uint8_t note);
+uint8_t VoicePool_StealQuietest(const struct voicePoolT *pool, uint8_t ch, uint8_t note);
+
+static inline uint8_t VoicePool_First(const struct voicePoolT *pool)
+{
+    return pool->head;
+}
+
+static inline uint8_t VoicePool_Next(const struct voicePoolT *pool, uint8_t voice)
+{
+    return pool->next[voice];
+}
+
+
+#endif /* SRC_ML_VOICE_POOL_H_ */
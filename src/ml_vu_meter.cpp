@@ -41,17 +41,16 @@
 
 
 #define VU_METER_DECREASE_MULTIPLIER 0.98f /* this controls how fast the vu meter falls over time */
-#define VU_METER_COUNT  2 /* we support two channels */
 
-/* 2 storages to allow double buffering */
-static float _vuMeterValueInBf[VU_METER_COUNT];
-static float _vuMeterValueDisp[VU_METER_COUNT];
+/*
+ * default instance used by the VuMeter_ functions
+ */
+static ML_VuMeter vuMeterDefault;
 
-static float _vuVal[VU_METER_COUNT];
 
-void VuMeter_Init(void)
+void ML_VuMeter::init(void)
 {
-    VuMeter_Process();
+    process();
 }
 
 inline float ValToDb(float in)
@@ -74,7 +73,7 @@ inline float ValToDb(float in)
     return out;
 }
 
-void VuMeter_Process(void)
+void ML_VuMeter::process(void)
 {
     memcpy(_vuMeterValueDisp, _vuMeterValueInBf, sizeof(_vuMeterValueDisp));
     for (int i = 0; i < 2; i++)
@@ -87,7 +86,7 @@ void VuMeter_Process(void)
 
 #define ABS_F(a) ((a>0)?(a):(-a))
 
-void VuMeter_PutSamples(float *left, float *right, uint32_t len)
+void ML_VuMeter::putSamples(float *left, float *right, uint32_t len)
 {
     for (uint32_t i = 0; i < len; i++)
     {
@@ -102,8 +101,31 @@ void VuMeter_PutSamples(float *left, float *right, uint32_t len)
     }
 }
 
-float getVuMeterVal(uint8_t idx)
+float ML_VuMeter::getValue(uint8_t idx)
 {
     return _vuVal[idx];
 }
 
+/*
+ * functions of the default instance
+ */
+void VuMeter_Init(void)
+{
+    vuMeterDefault.init();
+}
+
+void VuMeter_Process(void)
+{
+    vuMeterDefault.process();
+}
+
+void VuMeter_PutSamples(float *left, float *right, uint32_t len)
+{
+    vuMeterDefault.putSamples(left, right, len);
+}
+
+float getVuMeterVal(uint8_t idx)
+{
+    return vuMeterDefault.getValue(idx);
+}
+
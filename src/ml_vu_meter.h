@@ -44,6 +44,30 @@
 #include <Arduino.h>
 
 
+#define VU_METER_COUNT  2 /* we support two channels */
+
+/*
+ * one vu meter, the VuMeter_ functions below use a default instance
+ */
+class ML_VuMeter
+{
+public:
+    ML_VuMeter() {};
+    ~ML_VuMeter() {};
+    void init(void);
+    void process(void);
+    void putSamples(float *left, float *right, uint32_t len);
+    float getValue(uint8_t idx);
+
+private:
+    /* 2 storages to allow double buffering */
+    float _vuMeterValueInBf[VU_METER_COUNT] = {0};
+    float _vuMeterValueDisp[VU_METER_COUNT] = {0};
+
+    float _vuVal[VU_METER_COUNT] = {0};
+};
+
+
 void VuMeter_Init(void);
 void VuMeter_Process(void);
 void VuMeter_PutSamples(float *left, float *right, uint32_t len);